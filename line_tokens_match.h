@@ -16,6 +16,9 @@
  * <http://www.gnu.org/licenses/>.
  */
 
+#ifndef LINE_TOKENS_MATCH_H
+#define LINE_TOKENS_MATCH_H
+
 #include <assert.h>
 #include <stdbool.h>
 #include <string.h>
@@ -59,6 +62,13 @@
  *  !(pattern|pattern|...)  Matches anything within a token except one
  *                          occurence of the given patterns.
  *                          Does not match a token separator (space).
+ *
+ * The tries compiled from the pattern (see compile_pattern_tries) are used
+ * to match extended patterns with plain character byte alternatives unless
+ * tries is NULL.
+ * The analysis of the pattern (see analyze_patterns) is used to match
+ * possessive repetition extended patterns without backtracking unless
+ * analysis is NULL.
  */
 static bool
 line_tokens_match(
@@ -66,12 +76,16 @@ line_tokens_match(
 	char const *const line_end,
 	char const *pattern,
 	char const *const pattern_end,
+	struct pattern_tries const *const tries,
+	struct pattern_analysis const *const analysis,
 	bool const allow_prefix_match,
 	unsigned const recursion_limit
 	) {
 	struct tokens_match_config const config = {
 		allow_prefix_match,
-		{{1, "="}, {1, " "}}
+		{{1, "="}, {1, " "}},
+		tries,
+		analysis
 	};
 	assert(line <= line_end);
 	assert(pattern <= pattern_end);
@@ -89,6 +103,8 @@ static bool
 first_line_tokens_match(
 	char const *const lines,
 	char const *const pattern,
+	struct pattern_tries const *const tries,
+	struct pattern_analysis const *const analysis,
 	bool const allow_prefix_match,
 	unsigned const recursion_limit
 	) {
@@ -97,7 +113,11 @@ first_line_tokens_match(
 		lines + strcspn(lines, "\n"),
 		pattern,
 		pattern + strlen(pattern),
+		tries,
+		analysis,
 		allow_prefix_match,
 		recursion_limit
 		);
 }
+
+#endif  /* LINE_TOKENS_MATCH_H */
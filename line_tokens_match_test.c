@@ -21,13 +21,137 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "line_tokens_match.h"
+#include "pattern_analyze.h"
+#include "pattern_optimize.h"
+#include "pattern_segments.h"
+#include "pattern_trie_compile.h"
 
 #include "line_tokens_match_test.h"
 
+/* The step counts of a pattern summed over the matched variants.
+ */
+struct line_tokens_match_test_steps {
+	char const *pattern;
+	unsigned long calls;
+	unsigned long entities;
+	unsigned long compared;
+};
+
+#include "line_tokens_match_test_baseline.h"
+
+/* The allowed step count regression relative to the baseline.
+ */
+#define STEPS_TOLERANCE_PERCENT 10u
+#define STEPS_TOLERANCE_MIN 2u
+
+static void
+print_c_string(FILE *const out, char const *s) {
+	fputc('"', out);
+	for (; *s; ++s) {
+		/* Escape question marks, too, to avoid trigraphs.
+		 */
+		if (*s == '"' || *s == '\\' || *s == '?')
+			fputc('\\', out);
+		fputc(*s, out);
+	}
+	fputc('"', out);
+}
+
+static bool
+steps_regressed(unsigned long const actual, unsigned long const expected) {
+	return actual > expected +
+		expected * STEPS_TOLERANCE_PERCENT / 100u +
+		STEPS_TOLERANCE_MIN;
+}
+
+/* Trace the matcher decision events of a non-matching line.
+ * Returns true if the recursion limit is exhausted.
+ */
+static bool
+trace_line(
+	char const *const line,
+	char const *const pattern,
+	unsigned const recursion_limit
+	) {
+	struct tokens_match_trace_event events[TOKENS_MATCH_TRACE_SIZE];
+	tokens_match_trace.events = events;
+	tokens_match_trace.pattern_base = pattern;
+	tokens_match_trace.tokens_base = line;
+	tokens_match_trace.n = 0u;
+	assert(!first_line_tokens_match(
+		line,
+		pattern,
+		NULL,
+		NULL,
+		true,
+		recursion_limit
+		));
+	tokens_match_trace.events = NULL;
+	fprintf(
+		stderr,
+		"trace(\"%s\", \"%s\", %u): %lu events\n",
+		line,
+		pattern,
+		recursion_limit,
+		tokens_match_trace.n
+		);
+	assert(tokens_match_trace.n > 0u);
+	bool limit = false;
+	for (size_t i = 0u; i < TOKENS_MATCH_TRACE_SIZE; ++i) {
+		if (i >= tokens_match_trace.n)
+			break;
+		assert(events[i].kind != TOKENS_MATCH_TRACE_LINE);
+		assert(events[i].pattern_offset < strlen(pattern));
+		assert(events[i].tokens_offset <= strlen(line));
+		limit = limit || events[i].kind == TOKENS_MATCH_TRACE_LIMIT;
+	}
+	return limit;
+}
+
+/* Check that the matcher decision events are recorded to the trace ring buffer
+ * only when it is set.
+ */
+static void
+check_trace(void) {
+	tokens_match_trace.n = 0u;
+	assert(!first_line_tokens_match(
+		"abab",
+		"*(a|ab)c",
+		NULL,
+		NULL,
+		true,
+		6u
+		));
+	assert(tokens_match_trace.n == 0u);
+	assert(!trace_line("abab", "*(a|ab)c", 6u));
+	assert(trace_line("abab", "*(a|ab)c", 1u));
+	/* The ring buffer keeps the latest events.
+	 */
+	trace_line("abababababababab", "*(ab|a)*(b|ba)c", 6u);
+	assert(tokens_match_trace.n > TOKENS_MATCH_TRACE_SIZE);
+}
+
 int
-main() {
+main(int argc, char **argv) {
+	/* With -b, print a new step count baseline instead of comparing
+	 * the step counts against the baseline.
+	 */
+	bool const print_baseline = argc > 1 && strcmp(argv[1], "-b") == 0;
+	if (print_baseline)
+		printf(
+			"/* Generated by make update-steps-baseline."
+			" Do not edit.\n"
+			" */\n"
+			"\n"
+			"static const\n"
+			"struct line_tokens_match_test_steps"
+			" line_tokens_match_test_baseline[] = {\n"
+			);
+	size_t n_baseline = 0u;
 	unsigned const recursion_limit = 6u;
 	for (int i = 0; test_data[i].lines; ++i) {
 		char const *const lines = test_data[i].lines;
@@ -38,8 +162,61 @@ main() {
 		for (int j = 0; test_data[i].pattern_data[j].pattern; ++j) {
 			char const *const pattern =
 				test_data[i].pattern_data[j].pattern;
-			for (int k = 0; k < 2; ++k) {
-				bool const allow_prefix_match = (bool)k;
+			/* The optimized pattern and the patterns with compiled
+			 * tries must match the same.
+			 * All of them are analyzed as the possessive repetition
+			 * extended patterns are step counted without
+			 * backtracking.
+			 */
+			static struct character_byte_set const
+				pattern_separators = {1, "="},
+				token_separators = {1, " "};
+			char optimized[256];
+			assert(strlen(pattern) < sizeof optimized);
+			*optimize_pattern(
+				pattern,
+				pattern + strlen(pattern),
+				&pattern_separators,
+				&token_separators,
+				optimized
+				) = '\0';
+			char const *const optimized_pattern = optimized;
+			struct pattern_tries *const tries =
+				compile_pattern_tries(1, &pattern);
+			struct pattern_tries *const optimized_tries =
+				compile_pattern_tries(1, &optimized_pattern);
+			assert(tries && optimized_tries);
+			struct pattern_analysis *const analysis =
+				analyze_patterns(
+					1,
+					&pattern,
+					&pattern_separators,
+					&token_separators
+					);
+			struct pattern_analysis *const optimized_analysis =
+				analyze_patterns(
+					1,
+					&optimized_pattern,
+					&pattern_separators,
+					&token_separators
+					);
+			assert(analysis && optimized_analysis);
+			memset(
+				&tokens_match_stats,
+				0,
+				sizeof tokens_match_stats
+				);
+			struct {
+				char const *pattern;
+				struct pattern_tries const *tries;
+				struct pattern_analysis const *analysis;
+			} const variants[] = {
+				{pattern, NULL, analysis},
+				{pattern, tries, analysis},
+				{optimized, optimized_tries, optimized_analysis}
+			};
+			for (int k = 0; k < 6; ++k) {
+				bool const allow_prefix_match = (bool)(k % 2);
 				bool const expected =
 					(
 						allow_prefix_match ||
@@ -48,20 +225,25 @@ main() {
 					test_data[i].pattern_data[j].expected;
 				bool const actual = first_line_tokens_match(
 					lines,
-					pattern,
+					variants[k / 2].pattern,
+					variants[k / 2].tries,
+					variants[k / 2].analysis,
 					allow_prefix_match,
 					recursion_limit
 					);
 				fprintf(
 					stderr,
 					"first_line_tokens_match"
-					"(\"%.*s%.*s\", \"%s\", %s, %u)"
+					"(\"%.*s%.*s\", \"%s\", %s, %s, %u)"
 					" %s %s\n",
 					(int)m,
 					lines,
 					2 * (int)n,
 					"\\n",
-					pattern,
+					variants[k / 2].pattern,
+					variants[k / 2].tries
+						? "tries"
+						: "NULL",
 					allow_prefix_match ? "true" : "false",
 					recursion_limit,
 					actual == expected ? "==" : "!=",
@@ -69,9 +251,121 @@ main() {
 					);
 				if (actual != expected)
 					return 1;
+				/* The segment lengths may only reject lines
+				 * which do not match.
+				 */
+				char const *const pattern2 =
+					variants[k / 2].pattern;
+				struct pattern_segment segment_data[64];
+				struct pattern_segments const segments = {
+					measure_pattern_segments(
+						pattern2,
+						pattern2 + strlen(pattern2),
+						&pattern_separators,
+						&token_separators,
+						segment_data,
+						64u
+						),
+					segment_data
+				};
+				assert(segments.len <= 64u);
+				bool const fits = tokens_fit_pattern_segments(
+					&segments,
+					&pattern_separators,
+					&token_separators,
+					lines,
+					lines + m,
+					allow_prefix_match
+					);
+				fprintf(
+					stderr,
+					"tokens_fit_pattern_segments"
+					"(\"%s\", %s) %s\n",
+					pattern2,
+					allow_prefix_match ? "true" : "false",
+					fits ? "fits" : "does not fit"
+					);
+				if (!fits && expected)
+					return 1;
 			}
+			free(optimized_analysis);
+			free(analysis);
+			free(optimized_tries);
+			free(tries);
+			/* The step counts of all the variants must not regress.
+			 */
+			if (print_baseline) {
+				printf("\t{");
+				print_c_string(stdout, pattern);
+				printf(
+					", %luu, %luu, %luu},\n",
+					tokens_match_stats.calls,
+					tokens_match_stats.entities,
+					tokens_match_stats.compared
+					);
+				continue;
+			}
+			struct line_tokens_match_test_steps const
+				*const expected =
+					&line_tokens_match_test_baseline[
+						n_baseline++
+						];
+			if (
+				!expected->pattern ||
+				strcmp(expected->pattern, pattern) != 0
+				) {
+				fprintf(
+					stderr,
+					"steps(\"%s\") not in baseline"
+					" (run make update-steps-baseline)\n",
+					pattern
+					);
+				return 1;
+			}
+			fprintf(
+				stderr,
+				"steps(\"%s\")"
+				" calls %lu (%lu)"
+				", entities %lu (%lu)"
+				", compared %lu (%lu)\n",
+				pattern,
+				tokens_match_stats.calls,
+				expected->calls,
+				tokens_match_stats.entities,
+				expected->entities,
+				tokens_match_stats.compared,
+				expected->compared
+				);
+			if (
+				steps_regressed(
+					tokens_match_stats.calls,
+					expected->calls
+					) ||
+				steps_regressed(
+					tokens_match_stats.entities,
+					expected->entities
+					) ||
+				steps_regressed(
+					tokens_match_stats.compared,
+					expected->compared
+					)
+				)
+				return 1;
 		}
 	}
+	if (print_baseline) {
+		printf("\t{NULL, 0u, 0u, 0u}\n};\n");
+		return 0;
+	}
+	if (line_tokens_match_test_baseline[n_baseline].pattern) {
+		fprintf(
+			stderr,
+			"extra steps in baseline"
+			" (run make update-steps-baseline)\n"
+			);
+		return 1;
+	}
+	check_trace();
 	fprintf(stderr, "OK\n");
 	return 0;
 }
@@ -31,7 +31,7 @@ struct {
 		bool allow_prefix_match;
 		bool expected;
 		struct pattern_length_info expected_match_len;
-	} pattern_data[103];
+	} pattern_data[127];
 } test_data[] = {
 	/* The first line contains special pattern character bytes.
 	 */
@@ -259,6 +259,24 @@ struct {
 		{"* * ?", false, false, {3u, SIZE_MAX}},
 		{"* * ?*", false, true, {3u, SIZE_MAX}},
 		{"+(?)=+(?)=+(?)", false, true, {5u, MAX(3u * (size_t)UINT_MAX + 2u, UINT_MAX)}},
+		{"+([a-z]) +([a-z-]) +([a-f])==", false, true, {7u, MAX(3u * (size_t)UINT_MAX + 4u, UINT_MAX)}},
+		{"+([a-z])=+([a-z-])=+([a-f])*([=])", false, true, {5u, MAX(4u * (size_t)UINT_MAX + 2u, UINT_MAX)}},
+		{"+([a-z])=+([a-z])=*", false, false, {4u, SIZE_MAX}},
+		{"+([a-z])=*([a-z])-type=*", false, true, {8u, SIZE_MAX}},
+		{"*([!=])=*", true, true, {1u, SIZE_MAX}},
+		{"@(none|method|keyboard)=@(ssh-rsa|key-type)=@(AAAA|abcdef==)", false, true, {17u, 26u}},
+		{"@(meth|method)=*", true, true, {5u, SIZE_MAX}},
+		{"+(me|th|od)=*=*", false, true, {4u, SIZE_MAX}},
+		{"!(method|key-type)=*=*", false, false, {2u, SIZE_MAX}},
+		{"*=*=*(a|b|c|d|e|f)==", false, true, {4u, SIZE_MAX}},
+		{"*=*-type=*==", false, true, {9u, SIZE_MAX}},
+		{"*=*y-?ype=*", false, true, {8u, SIZE_MAX}},
+		{"*=*-typ=*", false, false, {6u, SIZE_MAX}},
+		{"*=*[!-]type=*", false, false, {7u, SIZE_MAX}},
+		{"*=*[!a-z]type=*", false, true, {7u, SIZE_MAX}},
+		{"*=*[-]t*=*", false, true, {4u, SIZE_MAX}},
+		{"*=*=*[e-f]==", false, true, {5u, SIZE_MAX}},
+		{"*=*[0-9]*=*", false, false, {3u, SIZE_MAX}},
 		{"method=key-type=*cdef==", false, true, {22u, SIZE_MAX}},
 		{"method=key-type=*?cdef==", false, true, {23u, SIZE_MAX}},
 		{"method=key-type=*??cdef==", false, true, {24u, SIZE_MAX}},
@@ -286,6 +304,15 @@ struct {
 		{"method=key-type=abcdef==*?", false, false, {25u, SIZE_MAX}},
 		{"method=key-type=abcdef==?", false, false, {25u, 25u}},
 		{"method=key-type=abcdef==?*", false, false, {25u, SIZE_MAX}},
+		{"method=key-type=abc\\def\\=\\=", false, true, {24u, 24u}},
+		{"method=key-type=abcdeg==", false, false, {24u, 24u}},
+		{"method=key-type=abcdef=", false, false, {23u, 23u}},
+		/* A prefix ends at the end of a token and therefore not after
+		 * a separator.
+		 */
+		{"method=", false, false, {7u, 7u}},
+		{"method=key-type", true, true, {15u, 15u}},
+		{"method=key-type=", false, false, {16u, 16u}},
 		{NULL, false, false, {0u, 0u}}
 	}},
 	{"method key=type abcdef==\n", {
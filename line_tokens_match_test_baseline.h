@@ -0,0 +1,271 @@
+/* Generated by make update-steps-baseline. Do not edit.
+ */
+
+static const
+struct line_tokens_match_test_steps line_tokens_match_test_baseline[] = {
+	{"[[]abbccc[]]", 6u, 18u, 48u},
+	{"[][]abbccc[][]", 6u, 18u, 48u},
+	{"\\[abbccc\\]", 6u, 12u, 48u},
+	{"[[]abbccc\?(dddd)[]]", 12u, 24u, 48u},
+	{"[[]\?(a)\?(bb)\?(ccc)\?(dddd)\?()[]]", 162u, 168u, 186u},
+	{"[[]\?(\?(a))\?(*(b))\?(@(ccc))\?(+(d))\?()[]]", 292u, 262u, 160u},
+	{"[[]*(|a)*(|b)*(|c)*(|d)*()[]]", 232u, 206u, 80u},
+	{"[[]*(\?(a))*(**(b))*(@(c))*(+(d))\?()[]]", 4406u, 3416u, 1050u},
+	{"[[]@(a)@(bb)@(ccc)@()[]]", 36u, 44u, 48u},
+	{"[[]@(\?(a))@(**(b))@(@(ccc))@()[]]", 194u, 154u, 114u},
+	{"[[]+(|a)+(|b)+(|c)+(|d)+()[]]", 232u, 206u, 80u},
+	{"[[]+(\?(|a))+(**(|b))+(@(|c))+(+(|d))+()[]]", 4136u, 2714u, 348u},
+	{"[[]!(|*b*|*c*)!(|*a*|*c*)!(|*a*|*b*)[]]", 312u, 282u, 288u},
+	{"[[]!(!(\?*)|*@(b)*|*+(c)*)!(!(\?*)|*@(a)*|*+(c)*)!(!(\?*)|*@(a)*|*+(b)*)[]]", 954u, 1044u, 264u},
+	{"[[][-a-z][-a-z-][-a-z-][a-z-][a-z-][a-z-][]]", 6u, 48u, 48u},
+	{"[[][!b-z][!ac-z][!ac-z][!abd-z][!abd-z][!abd-z][]]", 6u, 48u, 48u},
+	{"[[]!()[]]", 42u, 48u, 42u},
+	{"[[]!(\?\?\?)[]]", 48u, 66u, 42u},
+	{"[[]!(\?\?\?\?\?\?\?*)[]]", 48u, 54u, 48u},
+	{"[![]abbccc[]]", 6u, 6u, 6u},
+	{"[[][!a]bbccc[]]", 6u, 12u, 12u},
+	{"[[]a[!a-z]bccc[]]", 6u, 18u, 18u},
+	{"[[]abb[!ab-yz]cc[]]", 6u, 18u, 30u},
+	{"[[]abbccc[!]]", 6u, 18u, 48u},
+	{"[[]\?(a)\?(b)\?(ccc)[]]", 90u, 96u, 96u},
+	{"[[]@(a)@(b)@(ccc)[]]", 26u, 32u, 36u},
+	{"[[]+(|a)+(|b)+(|c)+(d)[]]", 136u, 116u, 74u},
+	{"[[]!(|*b*|*c*)!(|*b*)!(|*a*|*b*)[]]", 258u, 258u, 192u},
+	{"[\\]", 6u, 6u, 6u},
+	{"\\\\", 6u, 6u, 6u},
+	{"\\", 6u, 6u, 6u},
+	{"[!\\]", 6u, 6u, 6u},
+	{"[\\]-", 6u, 12u, 12u},
+	{"\\\\-", 6u, 6u, 12u},
+	{"\\-", 6u, 6u, 6u},
+	{"[!\\]-", 6u, 6u, 6u},
+	{"", 6u, 0u, 0u},
+	{"*", 6u, 6u, 0u},
+	{"@(*)", 10u, 6u, 0u},
+	{"!(!(*))", 12u, 6u, 0u},
+	{"!(\?\?|\?\?\?|\?\?\?\?|\?\?\?\?\?)", 12u, 6u, 0u},
+	{"*(\?)", 12u, 6u, 0u},
+	{"+(\?)+(\?)", 6u, 6u, 0u},
+	{"* *", 6u, 6u, 0u},
+	{"@(* *)", 6u, 6u, 0u},
+	{"*\?", 6u, 6u, 0u},
+	{"*\?\?", 6u, 6u, 0u},
+	{"\?", 6u, 6u, 0u},
+	{"\?\?", 6u, 6u, 0u},
+	{"\?*", 6u, 6u, 0u},
+	{"\?\?*", 6u, 6u, 0u},
+	{"!(*)", 6u, 6u, 0u},
+	{"!(|\?|\?\?|\?\?\?|\?\?\?\?|\?\?\?\?\?)", 6u, 6u, 0u},
+	{"", 6u, 0u, 0u},
+	{"*", 6u, 6u, 0u},
+	{"@(*)", 10u, 6u, 0u},
+	{"!(!(*))", 12u, 6u, 0u},
+	{"!(\?\?|\?\?\?|\?\?\?\?|\?\?\?\?\?)", 12u, 6u, 0u},
+	{"*(\?)", 12u, 6u, 0u},
+	{"+(\?)+(\?)", 6u, 6u, 0u},
+	{"* *", 6u, 6u, 0u},
+	{"@(* *)", 6u, 6u, 0u},
+	{"*\?", 6u, 6u, 0u},
+	{"*\?\?", 6u, 6u, 0u},
+	{"\?", 6u, 6u, 0u},
+	{"\?\?", 6u, 6u, 0u},
+	{"\?*", 6u, 6u, 0u},
+	{"\?\?*", 6u, 6u, 0u},
+	{"!(*)", 6u, 6u, 0u},
+	{"!(|\?|\?\?|\?\?\?|\?\?\?\?|\?\?\?\?\?)", 6u, 6u, 0u},
+	{"", 6u, 0u, 0u},
+	{"*", 6u, 6u, 0u},
+	{"@(*)", 58u, 30u, 0u},
+	{"!(!(*))", 210u, 168u, 0u},
+	{"!(\?\?|\?\?\?|\?\?\?\?|\?\?\?\?\?)", 84u, 186u, 0u},
+	{"*(\?)", 84u, 42u, 0u},
+	{"+(\?)+(\?)", 78u, 48u, 0u},
+	{"* *", 6u, 6u, 0u},
+	{"@(* *)", 12u, 12u, 36u},
+	{"*\?", 6u, 6u, 0u},
+	{"*\?\?", 6u, 6u, 0u},
+	{"\?", 6u, 6u, 0u},
+	{"\?\?", 6u, 12u, 0u},
+	{"\?*", 6u, 12u, 0u},
+	{"\?\?*", 6u, 18u, 0u},
+	{"!(*)", 42u, 42u, 0u},
+	{"!(|\?|\?\?|\?\?\?|\?\?\?\?|\?\?\?\?\?)", 132u, 216u, 0u},
+	{"*thod", 12u, 12u, 24u},
+	{"*\?thod", 12u, 12u, 24u},
+	{"*\?\?thod", 12u, 12u, 24u},
+	{"\?thod", 6u, 12u, 24u},
+	{"\?*thod", 12u, 18u, 24u},
+	{"\?\?thod", 6u, 18u, 24u},
+	{"\?\?*thod", 12u, 24u, 24u},
+	{"me*od", 12u, 18u, 24u},
+	{"me*\?od", 12u, 18u, 24u},
+	{"me*\?\?od", 12u, 18u, 24u},
+	{"me\?od", 6u, 18u, 24u},
+	{"me\?*od", 12u, 24u, 24u},
+	{"me\?\?od", 6u, 24u, 24u},
+	{"me\?\?*od", 12u, 30u, 24u},
+	{"meth", 6u, 6u, 24u},
+	{"meth*", 6u, 12u, 24u},
+	{"meth*\?", 6u, 12u, 24u},
+	{"meth*\?\?", 6u, 12u, 24u},
+	{"meth\?", 6u, 12u, 24u},
+	{"meth\?*", 6u, 18u, 24u},
+	{"meth\?\?", 6u, 18u, 24u},
+	{"meth\?\?*", 6u, 24u, 24u},
+	{"method", 6u, 6u, 36u},
+	{"method*", 6u, 12u, 36u},
+	{"method*\?", 6u, 12u, 36u},
+	{"method\?", 6u, 12u, 36u},
+	{"method\?*", 6u, 12u, 36u},
+	{"", 6u, 0u, 0u},
+	{"*", 6u, 6u, 0u},
+	{"@(*)", 58u, 30u, 0u},
+	{"*\?", 6u, 6u, 0u},
+	{"\?", 6u, 6u, 0u},
+	{"\?*", 6u, 12u, 0u},
+	{"*(\?)", 84u, 42u, 0u},
+	{"*thod", 12u, 12u, 24u},
+	{"*\?thod", 12u, 12u, 24u},
+	{"*\?\?thod", 12u, 12u, 24u},
+	{"\?thod", 6u, 12u, 24u},
+	{"\?*thod", 12u, 18u, 24u},
+	{"\?\?thod", 6u, 18u, 24u},
+	{"\?\?*thod", 12u, 24u, 24u},
+	{"me*od", 12u, 18u, 24u},
+	{"me*\?od", 12u, 18u, 24u},
+	{"me*\?\?od", 12u, 18u, 24u},
+	{"me\?od", 6u, 18u, 24u},
+	{"me\?*od", 12u, 24u, 24u},
+	{"me\?\?od", 6u, 24u, 24u},
+	{"me\?\?*od", 12u, 30u, 24u},
+	{"meth", 6u, 6u, 24u},
+	{"meth*", 6u, 12u, 24u},
+	{"meth*\?", 6u, 12u, 24u},
+	{"meth*\?\?", 6u, 12u, 24u},
+	{"meth\?", 6u, 12u, 24u},
+	{"meth\?*", 6u, 18u, 24u},
+	{"meth\?\?", 6u, 18u, 24u},
+	{"meth\?\?*", 6u, 24u, 24u},
+	{"method", 6u, 6u, 36u},
+	{"method*", 6u, 12u, 36u},
+	{"method*\?", 6u, 12u, 36u},
+	{"method\?", 6u, 12u, 36u},
+	{"method\?*", 6u, 12u, 36u},
+	{"* ", 6u, 12u, 6u},
+	{"* *", 6u, 18u, 6u},
+	{"@(* *)", 12u, 12u, 36u},
+	{"* *\?", 6u, 18u, 6u},
+	{"* \?", 6u, 18u, 6u},
+	{"* \?*", 6u, 24u, 6u},
+	{"+(\?)=+(\?)", 174u, 102u, 6u},
+	{"method=*-type", 12u, 24u, 72u},
+	{"method=*\?-type", 12u, 24u, 72u},
+	{"method=*\?\?\?-type", 12u, 24u, 72u},
+	{"method=\?-type", 6u, 24u, 72u},
+	{"method=\?*-type", 12u, 30u, 72u},
+	{"method=\?\?\?-type", 6u, 36u, 72u},
+	{"method=\?\?\?*-type", 12u, 42u, 72u},
+	{"method=key*type", 12u, 30u, 84u},
+	{"method=key*\?type", 12u, 30u, 84u},
+	{"method=key*\?\?type", 6u, 24u, 60u},
+	{"method=key\?type", 6u, 30u, 84u},
+	{"method=key\?*type", 12u, 36u, 84u},
+	{"method=key\?\?type", 6u, 36u, 60u},
+	{"method=key\?\?*type", 6u, 36u, 60u},
+	{"method=key-", 6u, 18u, 66u},
+	{"method=key-*", 6u, 24u, 66u},
+	{"method=key-*\?", 6u, 24u, 66u},
+	{"method=key-*\?\?\?\?", 6u, 24u, 66u},
+	{"method=key-\?", 6u, 24u, 66u},
+	{"method=key-\?*", 6u, 30u, 66u},
+	{"method=key-\?\?\?\?", 6u, 42u, 66u},
+	{"method=key-\?\?\?\?*", 6u, 48u, 66u},
+	{"method=key-type", 6u, 18u, 90u},
+	{"method=key-type*", 6u, 24u, 90u},
+	{"method=key-type*\?", 6u, 24u, 90u},
+	{"method=key-type\?", 6u, 24u, 90u},
+	{"method=key-type\?*", 6u, 24u, 90u},
+	{"* * ", 6u, 24u, 12u},
+	{"* * *", 6u, 30u, 12u},
+	{"* * * *", 6u, 30u, 12u},
+	{"* * *\?", 6u, 30u, 12u},
+	{"* * \?", 6u, 30u, 12u},
+	{"* * \?*", 6u, 36u, 12u},
+	{"+(\?)=+(\?)=+(\?)", 270u, 162u, 12u},
+	{"+([a-z]) +([a-z-]) +([a-f])==", 6u, 42u, 150u},
+	{"+([a-z])=+([a-z-])=+([a-f])*([=])", 168u, 144u, 174u},
+	{"+([a-z])=+([a-z])=*", 6u, 24u, 72u},
+	{"+([a-z])=*([a-z])-type=*", 6u, 36u, 102u},
+	{"*([!=])=*", 6u, 18u, 42u},
+	{"@(none|method|keyboard)=@(ssh-rsa|key-type)=@(AAAA|abcdef==)", 36u, 42u, 86u},
+	{"@(meth|method)=*", 28u, 30u, 50u},
+	{"+(me|th|od)=*=*", 36u, 42u, 36u},
+	{"!(method|key-type)=*=*", 44u, 8u, 12u},
+	{"*=*=*(a|b|c|d|e|f)==", 6u, 42u, 66u},
+	{"*=*-type=*==", 18u, 48u, 96u},
+	{"*=*y-\?ype=*", 12u, 48u, 42u},
+	{"*=*-typ=*", 12u, 24u, 30u},
+	{"*=*[!-]type=*", 12u, 24u, 12u},
+	{"*=*[!a-z]type=*", 12u, 42u, 42u},
+	{"*=*[-]t*=*", 12u, 48u, 48u},
+	{"*=*=*[e-f]==", 18u, 60u, 78u},
+	{"*=*[0-9]*=*", 6u, 18u, 54u},
+	{"method=key-type=*cdef==", 12u, 48u, 150u},
+	{"method=key-type=*\?cdef==", 12u, 48u, 150u},
+	{"method=key-type=*\?\?cdef==", 12u, 48u, 150u},
+	{"method=key-type=\?cdef==", 6u, 36u, 120u},
+	{"method=key-type=\?*cdef==", 12u, 54u, 144u},
+	{"method=key-type=\?\?cdef==", 6u, 54u, 132u},
+	{"method=key-type=\?\?*cdef==", 12u, 60u, 138u},
+	{"method=key-type=ab*==", 12u, 48u, 150u},
+	{"method=key-type=ab*\?==", 12u, 48u, 150u},
+	{"method=key-type=ab*\?\?\?\?==", 12u, 48u, 150u},
+	{"method=key-type=ab\?==", 6u, 42u, 114u},
+	{"method=key-type=ab\?*==", 12u, 54u, 144u},
+	{"method=key-type=ab\?\?\?\?==", 6u, 66u, 120u},
+	{"method=key-type=ab\?\?\?\?*==", 12u, 72u, 126u},
+	{"method=key-type=abcdef", 6u, 30u, 132u},
+	{"method=key-type=abcdef*", 6u, 36u, 132u},
+	{"method=key-type=abcdef*\?", 6u, 36u, 132u},
+	{"method=key-type=abcdef*\?\?", 6u, 36u, 132u},
+	{"method=key-type=abcdef\?", 6u, 36u, 132u},
+	{"method=key-type=abcdef\?*", 6u, 42u, 132u},
+	{"method=key-type=abcdef\?\?", 6u, 42u, 132u},
+	{"method=key-type=abcdef\?\?*", 6u, 48u, 132u},
+	{"method=key-type=abcdef==", 6u, 42u, 144u},
+	{"method=key-type=abcdef==*", 6u, 48u, 144u},
+	{"method=key-type=abcdef==*\?", 6u, 48u, 144u},
+	{"method=key-type=abcdef==\?", 6u, 48u, 144u},
+	{"method=key-type=abcdef==\?*", 6u, 48u, 144u},
+	{"method=key-type=abc\\def\\=\\=", 6u, 48u, 144u},
+	{"method=key-type=abcdeg==", 6u, 30u, 132u},
+	{"method=key-type=abcdef=", 6u, 36u, 138u},
+	{"method=", 6u, 12u, 42u},
+	{"method=key-type", 6u, 18u, 90u},
+	{"method=key-type=", 6u, 24u, 96u},
+	{"*=*k*=*b*==", 72u, 114u, 150u},
+	{"*=*k* *b*==", 24u, 66u, 84u},
+	{"*=*k*=*t*=*b*==", 48u, 102u, 114u},
+	{"*=*k*=*t* *b*==", 48u, 102u, 114u},
+	{"+(\?)=+(*k*)=+(*b*)==", 402u, 474u, 558u},
+	{"+(\?)=+(*k*) +(*b*)==", 396u, 420u, 492u},
+	{"+(\?)=+(*k*)=+(*t*)=+(*b*)==", 366u, 414u, 444u},
+	{"+(\?)=+(*k*)=+(*t*) +(*b*)==", 366u, 414u, 444u},
+	{"*=*k*=*b*=*\?*e*==", 78u, 138u, 156u},
+	{"*=*k*=*b* *\?*e*==", 78u, 138u, 156u},
+	{"*=*k* *b*=*\?*e*==", 30u, 90u, 90u},
+	{"*=*k* *b* *\?*e*==", 30u, 90u, 90u},
+	{"*=*k*=*t*=*\?*b*=*e*==", 54u, 126u, 120u},
+	{"*=*k*=*t*=*\?*b* *e*==", 54u, 126u, 120u},
+	{"*=*k*=*t* *\?*b*=*e*==", 54u, 126u, 120u},
+	{"*=*k*=*t* *\?*b* *e*==", 54u, 126u, 120u},
+	{"+(\?)=+(*k*)=+(*b*)=+(*\?*f==|*e)*==", 402u, 456u, 468u},
+	{"+(\?)=+(*k*)=+(*b*) +(*\?*f==|*e)*==", 402u, 456u, 468u},
+	{"+(\?)=+(*k*) +(*b*)=+(*\?*f==|*e)*==", 396u, 402u, 402u},
+	{"+(\?)=+(*k*) +(*b*) +(*\?*f==|*e)*==", 396u, 402u, 402u},
+	{"+(\?)=+(*k*)=+(*t*)=+(*\?*b*)=+(*f==|*e)*==", 342u, 372u, 342u},
+	{"+(\?)=+(*k*)=+(*t*)=+(*\?*b*) +(*f==|*e)*==", 342u, 372u, 342u},
+	{"+(\?)=+(*k*)=+(*t*) +(*\?*b*)=+(*f==|*e)*==", 342u, 372u, 342u},
+	{"+(\?)=+(*k*)=+(*t*) +(*\?*b*) +(*f==|*e)*==", 342u, 372u, 342u},
+	{NULL, 0u, 0u, 0u}
+};
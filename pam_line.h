@@ -0,0 +1,70 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAM_LINE_H
+#define PAM_LINE_H
+
+#include <stdbool.h>
+#include <string.h>
+
+/* The maximum number of arguments on a PAM configuration line.
+ */
+#define PAM_LINE_ARGS_MAX 1024
+
+/* Split a PAM configuration line to arguments in place.
+ * A bracketed argument ([...]) may contain spaces and escaped closing
+ * brackets (\]).
+ */
+static int
+split_pam_line(char *line, char **const argv, int const max_argc) {
+	int argc = 0;
+	for (;;) {
+		line += strspn(line, " \t\r\n");
+		if (!*line || *line == '#' || argc >= max_argc)
+			return argc;
+		if (*line == '[') {
+			char *out = argv[argc++] = line++;
+			for (; *line && *line != ']'; ++line) {
+				if (line[0] == '\\' && line[1] == ']')
+					++line;
+				*out++ = *line;
+			}
+			if (*line)
+				++line;
+			*out = '\0';
+			continue;
+		}
+		else {
+			argv[argc++] = line;
+			line += strcspn(line, " \t\r\n");
+		}
+		if (*line)
+			*line++ = '\0';
+	}
+}
+
+/* Check if an argument is a pam_ssh_auth_info module path.
+ */
+static bool
+is_module_path(char const *const arg) {
+	char const *const slash = strrchr(arg, '/');
+	char const *const name = slash ? slash + 1 : arg;
+	return strncmp(name, "pam_ssh_auth_info.", 18) == 0;
+}
+
+#endif  /* PAM_LINE_H */
@@ -0,0 +1,226 @@
+/*
+ * Copyright © 2021 - 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAM_OPTIONS_H
+#define PAM_OPTIONS_H
+
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum match_style {
+	MATCH_ALL_OF,
+	MATCH_ANY_OF,
+	MATCH_AT_LEAST,
+	MATCH_EXACTLY,
+	MATCH_NONE_OF
+};
+
+struct pam_options {
+	size_t complexity_limit;
+	size_t complexity_warn;
+	bool debug;
+	bool debug_timing;
+	char const *disable;
+	char const *enable;
+	bool export;
+	/* The first invalid option or NULL.
+	 */
+	char const *invalid;
+	unsigned log_sample;
+	enum match_style match_style;
+	size_t match_count;
+	bool quiet_fail;
+	bool quiet_success;
+	unsigned re_match_limit;
+	bool re_unanchored;
+	unsigned recursion_limit;
+	bool reorder;
+	char const *stats;
+	bool trace;
+};
+
+/* Parse a number option value (a non-empty unsigned decimal, octal or
+ * hexadecimal number without a sign) up to a maximum.
+ * Returns false if the number is invalid or out of range.
+ */
+static bool
+parse_pam_number(
+	char const *const s,
+	unsigned long long const max,
+	unsigned long long *const number
+	) {
+	if (*s < '0' || *s > '9')
+		return false;
+	char *end;
+	errno = 0;
+	unsigned long long const n = strtoull(s, &end, 0);
+	if (*end || errno == ERANGE || n > max)
+		return false;
+	*number = n;
+	return true;
+}
+
+/* Parse a line count or a complexity limit (see parse_pam_number).
+ */
+static bool
+parse_pam_line_count(char const *const s, size_t *const count) {
+	unsigned long long n;
+	if (!parse_pam_number(s, SIZE_MAX, &n))
+		return false;
+	*count = (size_t)n;
+	return true;
+}
+
+/* Parse a limit or a sample rate (see parse_pam_number).
+ */
+static bool
+parse_pam_limit(char const *const s, unsigned *const limit) {
+	unsigned long long n;
+	if (!parse_pam_number(s, UINT_MAX, &n))
+		return false;
+	*limit = (unsigned)n;
+	return true;
+}
+
+/* Parse module options.
+ * An invalid option value is stored to options->invalid (and it does not
+ * end the options).
+ * Returns the number of options (the index of the first pattern).
+ */
+static int
+parse_pam_options(
+	struct pam_options *const options,
+	int const argc,
+	char const *const *const argv
+	) {
+	static struct pam_options const defaults = {
+		0u,
+		0u,
+		false,
+		false,
+		NULL,
+		NULL,
+		false,
+		NULL,
+		0u,
+		MATCH_ALL_OF,
+		0u,
+		false,
+		false,
+		100000u,
+		false,
+		100u,
+		false,
+		NULL,
+		false
+	};
+	*options = defaults;
+	int i = 0;
+	for (; i < argc; ++i) {
+		if (strcmp(argv[i], "all_of") == 0)
+			options->match_style = MATCH_ALL_OF;
+		else if (strcmp(argv[i], "any_of") == 0)
+			options->match_style = MATCH_ANY_OF;
+		else if (strncmp(argv[i], "at_least=", 9) == 0) {
+			options->match_style = MATCH_AT_LEAST;
+			if (!parse_pam_line_count(
+				argv[i] + 9,
+				&options->match_count
+				) && !options->invalid)
+				options->invalid = argv[i];
+		}
+		else if (strncmp(argv[i], "complexity_limit=", 17) == 0) {
+			if (!parse_pam_line_count(
+				argv[i] + 17,
+				&options->complexity_limit
+				) && !options->invalid)
+				options->invalid = argv[i];
+		}
+		else if (strncmp(argv[i], "complexity_warn=", 16) == 0) {
+			if (!parse_pam_line_count(
+				argv[i] + 16,
+				&options->complexity_warn
+				) && !options->invalid)
+				options->invalid = argv[i];
+		}
+		else if (strcmp(argv[i], "debug") == 0)
+			options->debug = true;
+		else if (strcmp(argv[i], "debug=timing") == 0)
+			options->debug = options->debug_timing = true;
+		else if (strncmp(argv[i], "disable=", 8) == 0)
+			options->disable = argv[i] + 8;
+		else if (strncmp(argv[i], "enable=", 7) == 0)
+			options->enable = argv[i] + 7;
+		else if (strncmp(argv[i], "exactly=", 8) == 0) {
+			options->match_style = MATCH_EXACTLY;
+			if (!parse_pam_line_count(
+				argv[i] + 8,
+				&options->match_count
+				) && !options->invalid)
+				options->invalid = argv[i];
+		}
+		else if (strcmp(argv[i], "export") == 0)
+			options->export = true;
+		else if (strncmp(argv[i], "log_sample=", 11) == 0) {
+			if (!parse_pam_limit(
+				argv[i] + 11,
+				&options->log_sample
+				) && !options->invalid)
+				options->invalid = argv[i];
+		}
+		else if (strcmp(argv[i], "none_of") == 0)
+			options->match_style = MATCH_NONE_OF;
+		else if (strcmp(argv[i], "quiet") == 0)
+			options->quiet_fail = options->quiet_success = true;
+		else if (strcmp(argv[i], "quiet_fail") == 0)
+			options->quiet_fail = true;
+		else if (strcmp(argv[i], "quiet_success") == 0)
+			options->quiet_success = true;
+		else if (strncmp(argv[i], "re_match_limit=", 15) == 0) {
+			if (!parse_pam_limit(
+				argv[i] + 15,
+				&options->re_match_limit
+				) && !options->invalid)
+				options->invalid = argv[i];
+		}
+		else if (strcmp(argv[i], "re_unanchored") == 0)
+			options->re_unanchored = true;
+		else if (strncmp(argv[i], "recursion_limit=", 16) == 0) {
+			if (!parse_pam_limit(
+				argv[i] + 16,
+				&options->recursion_limit
+				) && !options->invalid)
+				options->invalid = argv[i];
+		}
+		else if (strcmp(argv[i], "reorder") == 0)
+			options->reorder = true;
+		else if (strncmp(argv[i], "stats=", 6) == 0)
+			options->stats = argv[i] + 6;
+		else if (strcmp(argv[i], "trace") == 0)
+			options->trace = true;
+		else
+			break;
+	}
+	return i;
+}
+
+#endif  /* PAM_OPTIONS_H */
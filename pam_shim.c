@@ -0,0 +1,244 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include "config.h"
+#endif
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_SECURITY_PAM_APPL_H) || !defined(PACKAGE_NAME)
+#	include <security/pam_appl.h>
+#endif
+#if defined(HAVE_SECURITY_PAM_EXT_H) || !defined(PACKAGE_NAME)
+#	include <security/pam_ext.h>
+#endif
+#if defined(HAVE_SECURITY_PAM_MODULES_H) || !defined(PACKAGE_NAME)
+#	include <security/pam_modules.h>
+#endif
+
+#include "pam_shim.h"
+
+struct pam_shim_data {
+	struct pam_shim_data *next;
+	char *name;
+	void *data;
+	void (*cleanup)(pam_handle_t *pamh, void *data, int error_status);
+};
+
+struct pam_handle {
+	char const *service;
+	char const *user;
+	FILE *log;
+	unsigned long syslog_count;
+	/* The environment variables (NAME=value).
+	 */
+	size_t env_len;
+	char **env;
+	struct pam_shim_data *data;
+};
+
+pam_handle_t *
+pam_shim_start(
+	char const *const service,
+	char const *const user,
+	FILE *const log
+	) {
+	pam_handle_t *const pamh = calloc(1u, sizeof *pamh);
+	if (!pamh)
+		return NULL;
+	pamh->service = service;
+	pamh->user = user;
+	pamh->log = log;
+	return pamh;
+}
+
+void
+pam_shim_end(pam_handle_t *const pamh, int const status) {
+	while (pamh->data) {
+		struct pam_shim_data *const data = pamh->data;
+		pamh->data = data->next;
+		if (data->cleanup)
+			data->cleanup(pamh, data->data, status);
+		free(data->name);
+		free(data);
+	}
+	for (size_t i = 0u; i < pamh->env_len; ++i)
+		free(pamh->env[i]);
+	free(pamh->env);
+	free(pamh);
+}
+
+unsigned long
+pam_shim_syslog_count(pam_handle_t const *const pamh) {
+	return pamh->syslog_count;
+}
+
+static struct pam_shim_data *
+find_pam_shim_data(pam_handle_t const *const pamh, char const *const name) {
+	struct pam_shim_data *data = pamh->data;
+	while (data && strcmp(data->name, name) != 0)
+		data = data->next;
+	return data;
+}
+
+/* Find an environment variable.
+ * Returns the index of the variable or the number of the variables if
+ * not found.
+ */
+static size_t
+find_pam_shim_env(
+	pam_handle_t const *const pamh,
+	char const *const name,
+	size_t const name_len
+	) {
+	size_t i = 0u;
+	for (; i < pamh->env_len; ++i) {
+		if (
+			strncmp(pamh->env[i], name, name_len) == 0 &&
+			pamh->env[i][name_len] == '='
+			)
+			break;
+	}
+	return i;
+}
+
+int
+pam_get_data(
+	pam_handle_t const *const pamh,
+	char const *const module_data_name,
+	void const **const data
+	) {
+	struct pam_shim_data const *const p =
+		find_pam_shim_data(pamh, module_data_name);
+	if (!p)
+		return PAM_NO_MODULE_DATA;
+	*data = p->data;
+	return PAM_SUCCESS;
+}
+
+int
+pam_get_item(
+	pam_handle_t const *const pamh,
+	int const item_type,
+	void const **const item
+	) {
+	switch (item_type) {
+	case PAM_SERVICE:
+		*item = pamh->service;
+		return PAM_SUCCESS;
+	case PAM_USER:
+		*item = pamh->user;
+		return PAM_SUCCESS;
+	default:
+		return PAM_BAD_ITEM;
+	}
+}
+
+char const *
+pam_getenv(pam_handle_t *const pamh, char const *const name) {
+	size_t const name_len = strlen(name);
+	size_t const i = find_pam_shim_env(pamh, name, name_len);
+	return i < pamh->env_len ? pamh->env[i] + name_len + 1u : NULL;
+}
+
+int
+pam_putenv(pam_handle_t *const pamh, char const *const name_value) {
+	size_t const name_len = strcspn(name_value, "=");
+	if (!name_len)
+		return PAM_BAD_ITEM;
+	size_t const i = find_pam_shim_env(pamh, name_value, name_len);
+	if (!name_value[name_len]) {  /* NAME removes the variable. */
+		if (i == pamh->env_len)
+			return PAM_BAD_ITEM;
+		free(pamh->env[i]);
+		pamh->env[i] = pamh->env[--pamh->env_len];
+		return PAM_SUCCESS;
+	}
+	char *const s = malloc(strlen(name_value) + 1u);
+	if (!s)
+		return PAM_BUF_ERR;
+	strcpy(s, name_value);
+	if (i < pamh->env_len) {
+		free(pamh->env[i]);
+		pamh->env[i] = s;
+		return PAM_SUCCESS;
+	}
+	char **const env = realloc(
+		pamh->env,
+		(pamh->env_len + 1u) * sizeof *env
+		);
+	if (!env) {
+		free(s);
+		return PAM_BUF_ERR;
+	}
+	pamh->env = env;
+	pamh->env[pamh->env_len++] = s;
+	return PAM_SUCCESS;
+}
+
+int
+pam_set_data(
+	pam_handle_t *const pamh,
+	char const *const module_data_name,
+	void *const data,
+	void (*const cleanup)(pam_handle_t *pamh, void *data, int error_status)
+	) {
+	struct pam_shim_data *p = find_pam_shim_data(pamh, module_data_name);
+	if (p) {
+		if (p->cleanup) {
+#ifdef PAM_DATA_REPLACE
+			p->cleanup(pamh, p->data, PAM_DATA_REPLACE);
+#else
+			p->cleanup(pamh, p->data, PAM_SUCCESS);
+#endif
+		}
+	}
+	else {
+		if (!(p = malloc(sizeof *p)))
+			return PAM_BUF_ERR;
+		if (!(p->name = malloc(strlen(module_data_name) + 1u))) {
+			free(p);
+			return PAM_BUF_ERR;
+		}
+		strcpy(p->name, module_data_name);
+		p->next = pamh->data;
+		pamh->data = p;
+	}
+	p->data = data;
+	p->cleanup = cleanup;
+	return PAM_SUCCESS;
+}
+
+#if defined(HAVE_PAM_SYSLOG) || !defined(PACKAGE_NAME)
+void
+pam_syslog(pam_handle_t const *pamh, int priority, char const *format, ...) {
+	/* Format the message like syslog would even if it is discarded.
+	 */
+	char buffer[1024];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(buffer, sizeof buffer, format, args);
+	va_end(args);
+	++((pam_handle_t *)pamh)->syslog_count;
+	if (pamh->log)
+		fprintf(pamh->log, "<%d> %s\n", priority, buffer);
+}
+#endif
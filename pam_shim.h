@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAM_SHIM_H
+#define PAM_SHIM_H
+
+#include <stdio.h>
+
+#if defined(HAVE_SECURITY_PAM_APPL_H) || !defined(PACKAGE_NAME)
+#	include <security/pam_appl.h>
+#endif
+
+/* A minimal in-tree stand-in for the PAM library functions used by
+ * the module (pam_get_data, pam_get_item, pam_getenv, pam_putenv,
+ * pam_set_data and pam_syslog) so that pam_sm_authenticate can be called
+ * directly without a PAM service file.
+ */
+
+/* Start a PAM transaction.
+ * The syslog messages are written to the log file unless it is NULL.
+ * Returns NULL if out of memory.
+ */
+pam_handle_t *
+pam_shim_start(char const *service, char const *user, FILE *log);
+
+/* End a PAM transaction and clean up the module data.
+ */
+void
+pam_shim_end(pam_handle_t *pamh, int status);
+
+/* Get the number of the syslog messages.
+ */
+unsigned long
+pam_shim_syslog_count(pam_handle_t const *pamh);
+
+#endif  /* PAM_SHIM_H */
@@ -30,12 +30,28 @@
 #define PAM_SM_AUTH
 #define PAM_SM_SESSION
 #define PAM_SM_PASSWORD
+#ifdef ENABLE_MATCHER_STATS
+/* Collect the matching statistics for the stats and debug=timing options.
+ */
+#	define TOKENS_MATCH_STATS
+/* Record the matcher decision events for the trace option (which depends on
+ * the matching statistics, too).
+ */
+#	define TOKENS_MATCH_TRACE
+#endif
 
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdarg.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <syslog.h>
+#include <unistd.h>
 
 #if defined(HAVE_SECURITY_PAM_APPL_H) || !defined(PACKAGE_NAME)
 #	include <security/pam_appl.h>
@@ -47,8 +63,14 @@
 #	include <security/pam_modules.h>
 #endif
 
-#include "line_tokens_match.h"
+#include "pam_options.h"
+#include "pam_stats_update.h"
 #include "pam_syslog.h"
+#include "pattern_complexity.h"
+#include "pattern_set.h"
+#include "pattern_set_match.h"
+#include "probes.h"
+#include "ssh_key_fingerprint.h"
 
 /* Check if a string is in a list separated by separators.
  */
@@ -77,68 +99,950 @@ next_line(char const *s) {
 	return s;
 }
 
-int
-pam_sm_authenticate(
-	pam_handle_t *pamh,
-	int flags,
+/* Count the lines.
+ */
+static size_t
+count_lines(char const *s) {
+	size_t n = 0u;
+	for (; *s; s = next_line(s))
+		++n;
+	return n;
+}
+
+/* Measure the length of the longest line.
+ */
+static size_t
+measure_longest_line(char const *s) {
+	size_t len = 0u;
+	for (; *s; s = next_line(s)) {
+		size_t const n = strcspn(s, "\n");
+		if (len < n)
+			len = n;
+	}
+	return len;
+}
+
+/* Get the monotonic time in nanoseconds.
+ */
+static uint64_t
+now_nanoseconds(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * UINT64_C(1000000000) +
+		(uint64_t)ts.tv_nsec;
+}
+
+/* Decide whether to log the debugging messages of an invocation (see
+ * the log_sample option).
+ * One in n invocations is chosen at random.
+ */
+static bool
+sample_log(unsigned const n) {
+	if (n <= 1u)
+		return true;
+	/* Mix the time and the process ID (see splitmix64).
+	 */
+	uint64_t x = now_nanoseconds() ^ (uint64_t)getpid() << 32;
+	x = (x ^ x >> 30) * UINT64_C(0xbf58476d1ce4e5b9);
+	x = (x ^ x >> 27) * UINT64_C(0x94d049bb133111eb);
+	x ^= x >> 31;
+	return x % n == 0u;
+}
+
+#define LOG_RECORD_SIZE 2048u
+
+/* A log record.
+ *
+ * The debugging messages of an invocation are collected to a bounded buffer
+ * and logged together with the result as a single record (see log_result)
+ * instead of a syslog call per message.
+ * The messages are separated by "; ".
+ * A message which does not fit and the messages after it are dropped but
+ * counted.
+ */
+struct log_record {
+	size_t len;
+	size_t dropped;
+	char text[LOG_RECORD_SIZE];
+};
+
+static void
+log_record_init(struct log_record *const record) {
+	record->len = 0u;
+	record->dropped = 0u;
+	record->text[0] = '\0';
+}
+
+/* Add a message to a log record.
+ */
+static void
+log_record_add(
+	struct log_record *const record,
+	char const *const format,
+	...
+	) {
+	size_t const sep = record->len ? 2u : 0u;
+	size_t const room = sizeof record->text - record->len;
+	int n = -1;
+	if (!record->dropped && room > sep) {
+		va_list args;
+		va_start(args, format);
+		n = vsnprintf(
+			record->text + record->len + sep,
+			room - sep,
+			format,
+			args
+			);
+		va_end(args);
+	}
+	if (n < 0 || (size_t)n >= room - sep) {
+		record->text[record->len] = '\0';
+		++record->dropped;
+		return;
+	}
+	memcpy(record->text + record->len, "; ", sep);
+	record->len += sep + (size_t)n;
+}
+
+/* Format the number of the dropped messages of a log record (or nothing).
+ */
+static void
+format_log_record_dropped(
+	struct log_record const *const record,
+	char *const buffer,
+	size_t const size
+	) {
+	if (record->dropped)
+		snprintf(
+			buffer,
+			size,
+			" (%zu messages dropped)",
+			record->dropped
+			);
+	else if (size > 0u)
+		*buffer = '\0';
+}
+
+/* Analyze the worst-case complexities of the optimized patterns (see
+ * the complexity_limit and complexity_warn options).
+ * Regular expression patterns are bounded by the match limit instead and
+ * their bounds are left zero.
+ * Returns an array of the step bounds of the patterns which must be freed
+ * with free or NULL if out of memory.
+ */
+static struct pattern_complexity_bound *
+analyze_patterns_complexities(
+	int const argc,
+	char const *const *const argv,
+	char const *const *const patterns
+	) {
+	struct pattern_complexity_bound *const bounds = calloc(
+		(size_t)argc + 1u,
+		sizeof *bounds
+		);
+	if (!bounds)
+		return NULL;
+	for (int i = 0; i < argc; ++i) {
+		if (is_regular_expression_pattern(argv[i]))
+			continue;
+		struct pattern_complexity_info info;
+		analyze_pattern_complexity(
+			patterns[i],
+			patterns[i] + strlen(patterns[i]),
+			&pattern_separators,
+			&token_separators,
+			&info
+			);
+		bounds[i] = info.steps;
+	}
+	return bounds;
+}
+
+/* Check the worst-case complexities of the patterns against the complexity
+ * limits.
+ * Returns false if some pattern exceeds the complexity_limit option.
+ */
+static bool
+check_pattern_complexities(
+	pam_handle_t *const pamh,
+	struct pam_options const *const options,
+	int const argc,
+	char const *const *const argv,
+	struct pattern_complexity_bound const *const bounds,
+	size_t const tokens_len
+	) {
+	for (int i = 0; i < argc; ++i) {
+		if (is_regular_expression_pattern(argv[i]))
+			continue;
+		size_t const steps = evaluate_pattern_complexity_bound(
+			&bounds[i],
+			tokens_len,
+			options->recursion_limit
+			);
+		if (options->complexity_limit && (
+			steps > options->complexity_limit
+			)) {
+			pam_syslog(
+				pamh,
+				LOG_ERR,
+				"pattern \"%s\" worst-case step bound %zu"
+				" exceeds complexity_limit=%zu",
+				argv[i],
+				steps,
+				options->complexity_limit
+				);
+			return false;
+		}
+		if (options->complexity_warn && (
+			steps > options->complexity_warn
+			))
+			pam_syslog(
+				pamh,
+				LOG_WARNING,
+				"pattern \"%s\" worst-case step bound %zu"
+				" exceeds complexity_warn=%zu",
+				argv[i],
+				steps,
+				options->complexity_warn
+				);
+	}
+	return true;
+}
+
+/* The counters of a row of the match matrix (see the stats and debug=timing
+ * options).
+ */
+struct match_row_counters {
+	struct pam_stats_counters stats;
+	/* The number of the partial match calls after the first one per line.
+	 */
+	uint64_t backtracks;
+};
+
+/* The context of match_line_hook.
+ */
+struct match_line_context {
+	pam_handle_t *pamh;
+	/* The original patterns.
+	 */
+	char const *const *argv;
+	/* The counters of the rows or NULL.
+	 */
+	struct match_row_counters *counters;
+	struct log_record *log;
+};
+
+/* Match a line against a pattern (see pattern_set_match_line) and collect
+ * the trace events, the probes, the counters of the row (unless NULL) and
+ * the debugging messages (with key blobs abbreviated to fingerprints) of
+ * the match.
+ * The debugging messages refer to the original pattern.
+ */
+static int
+match_line_hook(
+	void *const context,
+	struct pattern_set const *const set,
+	struct pattern_set_scratch *const scratch,
+	size_t const i,
+	size_t const j,
+	char const *const line,
+	char const *const line_end
+	) {
+	struct match_line_context const *const c = context;
+	char const *const pattern = c->argv[i];
+	struct match_row_counters *const counters =
+		c->counters ? &c->counters[i] : NULL;
+	uint64_t const start = counters ? now_nanoseconds() : 0u;
+#ifdef TOKENS_MATCH_STATS
+	struct tokens_match_stats const before = tokens_match_stats;
+	tokens_match_stats.recursion_limit_min = set->recursion_limit;
+#endif
+#ifdef TOKENS_MATCH_TRACE
+	tokens_match_trace.pattern_base = set->patterns[i];
+	tokens_match_trace.tokens_base = line;
+#endif
+	int const rc = pattern_set_match_line(set, scratch, i, line, line_end);
+	bool const matches = rc > 0;
+#ifdef HAVE_PCRE2
+	if (rc < 0) {
+		char message[256];
+		get_regular_expression_error_message(
+			rc,
+			message,
+			sizeof message
+			);
+		pam_syslog(
+			c->pamh,
+			LOG_WARNING,
+			"regular expression pattern \"%s\": %s",
+			pattern,
+			message
+			);
+	}
+#endif
+#ifdef TOKENS_MATCH_TRACE
+	if (tokens_match_trace.events)
+		tokens_match_trace_add(
+			TOKENS_MATCH_TRACE_LINE,
+			(unsigned)i,
+			(unsigned)j,
+			matches
+			);
+#else
+	(void)j;
+#endif
+	PROBE5(
+		pattern__line,
+		i,
+		pattern,
+		line,
+		(size_t)(line_end - line),
+		matches
+		);
+	if (counters) {
+		++counters->stats.evaluations;
+		counters->stats.matches += matches;
+		counters->stats.exhaustions += rc < 0;
+		counters->stats.nanoseconds += now_nanoseconds() - start;
+#ifdef TOKENS_MATCH_STATS
+		uint64_t const depth = set->recursion_limit -
+			tokens_match_stats.recursion_limit_min;
+		counters->stats.steps +=
+			(tokens_match_stats.calls - before.calls) +
+			(tokens_match_stats.entities - before.entities);
+		counters->stats.exhaustions +=
+			tokens_match_stats.exhaustions - before.exhaustions;
+		if (counters->stats.max_depth < depth)
+			counters->stats.max_depth = depth;
+		if (tokens_match_stats.calls > before.calls)
+			counters->backtracks +=
+				tokens_match_stats.calls - before.calls - 1u;
+#endif
+	}
+	if (c->log) {
+		char abbreviated[256];
+		abbreviate_ssh_auth_info_line(
+			line,
+			line_end,
+			abbreviated,
+			sizeof abbreviated
+			);
+		log_record_add(
+			c->log,
+			"line \"%s\" %s pattern \"%s\"",
+			abbreviated,
+			matches ? "matches" : "does not match",
+			pattern
+			);
+	}
+	return rc;
+}
+
+/* Add a summary per pattern to a log record (see the debug=timing option).
+ */
+static void
+log_pattern_timings(
+	struct log_record *const log,
+	struct match_matrix const *const matrix,
+	struct match_row_counters const *const row_counters,
+	int const argc,
+	char const *const *const argv
+	) {
+	for (int i = 0; i < argc; ++i) {
+		struct pam_stats_counters const *const counters =
+			&row_counters[i].stats;
+		if (!bitmap_test(matrix->evaluated, (size_t)i)) {
+			log_record_add(
+				log,
+				"pattern \"%s\" not evaluated",
+				argv[i]
+				);
+			continue;
+		}
+		log_record_add(
+			log,
+			"pattern \"%s\""
+			" matched %" PRIu64 " of %" PRIu64 " lines"
+			" in %" PRIu64 " ns"
+			" (recursion depth %" PRIu64
+			", %" PRIu64 " steps"
+			", %" PRIu64 " backtracks)"
+			"%s",
+			argv[i],
+			counters->matches,
+			counters->evaluations,
+			counters->nanoseconds,
+			counters->max_depth,
+			counters->steps,
+			row_counters[i].backtracks,
+			counters->exhaustions
+				? ": cut off by the recursion or match limit"
+				: ""
+			);
+	}
+}
+
+#ifdef TOKENS_MATCH_TRACE
+/* Log the events of a trace ring buffer (see the trace option) as a single
+ * message, the oldest event first.
+ */
+static void
+log_trace(
+	pam_handle_t *const pamh,
+	struct tokens_match_trace_event const *const events,
+	unsigned long const n
+	) {
+	static char const *const kinds[] = {
+		"line",
+		"extended",
+		"wildcard",
+		"limit"
+	};
+	struct log_record record;
+	log_record_init(&record);
+	unsigned long const first =
+		n > TOKENS_MATCH_TRACE_SIZE ? n - TOKENS_MATCH_TRACE_SIZE : 0u;
+	for (unsigned long k = first; k < n; ++k) {
+		struct tokens_match_trace_event const *const event =
+			&events[k % TOKENS_MATCH_TRACE_SIZE];
+		log_record_add(
+			&record,
+			"%s %u:%u %s",
+			kinds[event->kind],
+			event->pattern_offset,
+			event->tokens_offset,
+			event->result ? "matched" : "failed"
+			);
+	}
+	char dropped[64];
+	format_log_record_dropped(&record, dropped, sizeof dropped);
+	pam_syslog(
+		pamh,
+		LOG_INFO,
+		"ssh auth info trace (last %lu of %lu events): %s%s",
+		n - first,
+		n,
+		record.text,
+		dropped
+		);
+}
+#endif
+
+/* The preprocessed patterns of a module configuration.
+ *
+ * The patterns are optimized, analyzed, compiled and ordered only once per
+ * PAM handle (see get_pattern_config) and not again for every call.
+ */
+struct pattern_config {
+	struct pattern_set set;
+	/* The scratch for matching the pattern set (a PAM handle is not used
+	 * concurrently).
+	 */
+	struct pattern_set_scratch scratch;
+	/* The worst-case step bounds of the patterns or NULL if not needed
+	 * (see analyze_patterns_complexities).
+	 */
+	struct pattern_complexity_bound *complexities;
+};
+
+/* Destroy a pattern configuration (even if partially created).
+ */
+static void
+destroy_pattern_config(struct pattern_config *const config) {
+	if (!config)
+		return;
+	pattern_set_scratch_destroy(&config->scratch);
+	pattern_set_destroy(&config->set);
+	free(config->complexities);
+	free(config);
+}
+
+static void
+cleanup_pattern_config(pam_handle_t *pamh, void *data, int error_status) {
+	(void)pamh;
+	(void)error_status;
+	destroy_pattern_config(data);
+}
+
+/* Preprocess the patterns of a module configuration (see pattern_set_init).
+ * Errors are logged.
+ * Returns PAM_SUCCESS or an error code.
+ */
+static int
+create_pattern_config(
+	pam_handle_t *const pamh,
+	struct pam_options const *const options,
+	int const argc,
+	char const *const *const argv,
+	struct pattern_config **const config_out
+	) {
+	struct pattern_config *const config = calloc(1u, sizeof *config);
+	if (!config) {
+		pam_syslog(pamh, LOG_CRIT, "out of memory");
+		return PAM_BUF_ERR;
+	}
+	char error[1024];
+	int const error_number = pattern_set_init(
+		&config->set,
+		options,
+		argc,
+		argv,
+		error,
+		sizeof error
+		);
+	if (error_number) {
+		destroy_pattern_config(config);
+		pam_syslog(
+			pamh,
+			error_number == ENOMEM ? LOG_CRIT : LOG_ERR,
+			"%s",
+			error
+			);
+		return error_number == ENOMEM ? PAM_BUF_ERR : PAM_SERVICE_ERR;
+	}
+	if (
+		((options->complexity_limit || options->complexity_warn) &&
+			!(config->complexities = analyze_patterns_complexities(
+				argc,
+				argv,
+				config->set.patterns
+				))) ||
+		!pattern_set_scratch_init(&config->set, &config->scratch)
+		) {
+		destroy_pattern_config(config);
+		pam_syslog(pamh, LOG_CRIT, "out of memory");
+		return PAM_BUF_ERR;
+	}
+	*config_out = config;
+	return PAM_SUCCESS;
+}
+
+/* Get the preprocessed patterns of a module configuration.
+ *
+ * The configuration is stored in the PAM handle (by the module arguments)
+ * so that it is created only once per handle (and not again for the other
+ * module types).
+ * Errors are logged.
+ * Returns PAM_SUCCESS or an error code.
+ */
+static int
+get_pattern_config(
+	pam_handle_t *const pamh,
+	struct pam_options const *const options,
+	int const n_args,
+	char const *const *const args,
+	int const n_options,
+	struct pattern_config **const config_out
+	) {
+	static char const prefix[] = "pam_ssh_auth_info_config";
+	size_t name_size = sizeof prefix;
+	for (int i = 0; i < n_args; ++i)
+		name_size += 1u + strlen(args[i]);
+	char *const name = malloc(name_size);
+	if (!name) {
+		pam_syslog(pamh, LOG_CRIT, "out of memory");
+		return PAM_BUF_ERR;
+	}
+	char *p = name + sizeof prefix - 1u;
+	memcpy(name, prefix, sizeof prefix);
+	for (int i = 0; i < n_args; ++i) {
+		size_t const len = strlen(args[i]);
+		*p++ = '\n';
+		memcpy(p, args[i], len + 1u);
+		p += len;
+	}
+	void const *data = NULL;
+	if (pam_get_data(pamh, name, &data) == PAM_SUCCESS && data) {
+		free(name);
+		*config_out = (struct pattern_config *)data;
+		return PAM_SUCCESS;
+	}
+	struct pattern_config *config = NULL;
+	int const ret = create_pattern_config(
+		pamh,
+		options,
+		n_args - n_options,
+		args + n_options,
+		&config
+		);
+	if (ret != PAM_SUCCESS) {
+		free(name);
+		return ret;
+	}
+	if (pam_set_data(
+		pamh,
+		name,
+		config,
+		cleanup_pattern_config
+		) != PAM_SUCCESS) {
+		free(name);
+		destroy_pattern_config(config);
+		pam_syslog(pamh, LOG_CRIT, "out of memory");
+		return PAM_BUF_ERR;
+	}
+	free(name);
+	*config_out = config;
+	return PAM_SUCCESS;
+}
+
+/* Append a string to a stats text (truncating it if necessary).
+ * Returns the new text length.
+ */
+static size_t
+append_stats_text(char *const text, size_t const len, char const *const s) {
+	size_t n = strlen(s);
+	if (n > PAM_STATS_TEXT_SIZE - 1u - len)
+		n = PAM_STATS_TEXT_SIZE - 1u - len;
+	memcpy(text + len, s, n);
+	text[len + n] = '\0';
+	return len + n;
+}
+
+/* Add the counters of an invocation to a stats file (see the stats option).
+ *
+ * The configuration is identified by the service and the module arguments
+ * and the patterns by the configuration, the pattern index and the pattern.
+ * counters[i] must contain the counters of the pattern i.
+ * Errors are logged but they do not affect the result.
+ */
+static void
+record_stats(
+	pam_handle_t *const pamh,
+	char const *const file_name,
+	int const n_options,
+	int const argc,
+	char const *const *const argv,
+	struct pam_stats_counters const *const total,
+	struct match_row_counters const *const counters
+	) {
+	struct pam_stats_file *const file = open_pam_stats_file(
+		file_name,
+		true
+		);
+	if (!file) {
+		pam_syslog(
+			pamh,
+			LOG_WARNING,
+			"stats file %s: %s",
+			file_name,
+			strerror(errno)
+			);
+		return;
+	}
+	char const *service = NULL;
+	if (pam_get_item(
+		pamh,
+		PAM_SERVICE,
+		(void const **)&service
+		) != PAM_SUCCESS || !service)
+		service = "";
+	char text[PAM_STATS_TEXT_SIZE];
+	size_t len = append_stats_text(text, 0u, service);
+	len = append_stats_text(text, len, ":");
+	uint64_t key = hash_pam_stats_key(0u, service, strlen(service) + 1u);
+	for (int i = 0; i < argc; ++i) {
+		len = append_stats_text(text, len, " ");
+		len = append_stats_text(text, len, argv[i]);
+		key = hash_pam_stats_key(key, argv[i], strlen(argv[i]) + 1u);
+	}
+	struct pam_stats_slot *slot = find_pam_stats_slot(
+		file,
+		key,
+		PAM_STATS_CONFIG,
+		0u,
+		0u,
+		text,
+		len
+		);
+	if (slot)
+		add_pam_stats_counters(slot, total);
+	for (int i = n_options; slot && i < argc; ++i) {
+		uint32_t const index = (uint32_t)(i - n_options);
+		uint64_t const pattern_key = hash_pam_stats_key(
+			hash_pam_stats_key(key, &index, sizeof index),
+			argv[i],
+			strlen(argv[i])
+			);
+		slot = find_pam_stats_slot(
+			file,
+			pattern_key,
+			PAM_STATS_PATTERN,
+			key,
+			index,
+			argv[i],
+			strlen(argv[i])
+			);
+		if (slot)
+			add_pam_stats_counters(slot, &counters[index].stats);
+	}
+	if (!slot)
+		pam_syslog(
+			pamh,
+			LOG_WARNING,
+			"stats file %s is full",
+			file_name
+			);
+	close_pam_stats_file(file);
+}
+
+/* Log the result (see authenticate) followed by the log record (unless NULL)
+ * as a single message.
+ * If quiet is true, the result is logged only as a debugging message heading
+ * a non-empty log record.
+ */
+static void
+log_result(
+	pam_handle_t *const pamh,
+	struct log_record const *const log,
+	bool const quiet,
+	int const ret,
+	char const *const decisive_pattern
+	) {
+	bool const details = log && (log->len || log->dropped);
+	if (quiet && !details)
+		return;
+	char const *user = NULL;
+	if (pam_get_item(
+		pamh,
+		PAM_USER,
+		(void const **)&user
+		) != PAM_SUCCESS || user == NULL)
+		user = "(unknown)";
+	char dropped[64] = "";
+	if (details)
+		format_log_record_dropped(log, dropped, sizeof dropped);
+	pam_syslog(
+		pamh,
+		quiet ? LOG_DEBUG : LOG_INFO,
+		"ssh auth info %s%s%s%s %s by user %s%s%s%s",
+		decisive_pattern
+			? "pattern requirement"
+			: "pattern requirements",
+		decisive_pattern ? " \"" : "",
+		decisive_pattern ? decisive_pattern : "",
+		decisive_pattern ? "\""  : "",
+		ret == PAM_SUCCESS
+			? "met"
+			: ret == PAM_AUTH_ERR ? "not met" : "not evaluated",
+		user,
+		details ? ": " : "",
+		details ? log->text : "",
+		dropped
+		);
+}
+
+/* The fields of the SSH authentication information lines exported by
+ * the export option.
+ */
+enum export_field {
+	EXPORT_METHOD,
+	EXPORT_KEY_TYPE,
+	EXPORT_KEY_FINGERPRINT
+};
+
+/* Set a PAM environment variable to a comma separated list of a field of
+ * the SSH authentication information lines (the key fields only of
+ * the publickey lines).
+ * Returns PAM_SUCCESS or an error (see pam_putenv).
+ */
+static int
+export_field_list(
+	pam_handle_t *const pamh,
+	char const *const name,
+	char const *const ssh_auth_info,
+	enum export_field const field
+	) {
+	size_t const name_len = strlen(name);
+	char *const buffer = malloc(
+		name_len + 1u +
+		strlen(ssh_auth_info) +
+		count_lines(ssh_auth_info) * SSH_KEY_FINGERPRINT_SIZE +
+		1u
+		);
+	if (!buffer)
+		return PAM_BUF_ERR;
+	memcpy(buffer, name, name_len);
+	char *const list = buffer + name_len + 1u;
+	char *p = list;
+	list[-1] = '=';
+	for (char const *s = ssh_auth_info; *s; s = next_line(s)) {
+		char const *const line_end = s + strcspn(s, "\n");
+		char const *token = s;
+		char const *token_end = s + strcspn(s, " \n");
+		if (field != EXPORT_METHOD && (
+			token_end - token != 9 ||
+			strncmp(token, "publickey", 9u) != 0
+			))
+			continue;
+		for (int i = EXPORT_METHOD; i < (int)field; ++i) {
+			token = token_end < line_end ? token_end + 1 : line_end;
+			token_end = token + strcspn(token, " \n");
+		}
+		char fingerprint[SSH_KEY_FINGERPRINT_SIZE];
+		if (field == EXPORT_KEY_FINGERPRINT) {
+			if (!format_ssh_key_fingerprint(
+				token,
+				token_end,
+				fingerprint
+				))
+				continue;
+			token = fingerprint;
+			token_end = fingerprint + strlen(fingerprint);
+		}
+		if (token == token_end)
+			continue;
+		if (p != list)
+			*p++ = ',';
+		memcpy(p, token, (size_t)(token_end - token));
+		p += token_end - token;
+	}
+	*p = '\0';
+	int const ret = pam_putenv(pamh, buffer);
+	free(buffer);
+	return ret;
+}
+
+/* Publish the result (see authenticate), the decisive pattern index,
+ * the authentication methods, the key types and the key fingerprints to
+ * the PAM environment for the later modules (the export option).
+ * The variables are always set (possibly to empty values) so that no stale
+ * values of an earlier invocation remain.
+ * Unless the patterns were evaluated (the result is PAM_SUCCESS or
+ * PAM_AUTH_ERR), only the result is non-empty.
+ * Returns PAM_SUCCESS or an error (see pam_putenv).
+ */
+static int
+export_results(
+	pam_handle_t *const pamh,
+	char const *ssh_auth_info,
+	int const result,
+	int const decisive_index
+	) {
+	char const *const result_variable =
+		result == PAM_SUCCESS ? "PAM_SSH_AUTH_INFO_RESULT=success" :
+		result == PAM_AUTH_ERR ? "PAM_SSH_AUTH_INFO_RESULT=failure" :
+		result == PAM_IGNORE ? "PAM_SSH_AUTH_INFO_RESULT=ignored" :
+		"PAM_SSH_AUTH_INFO_RESULT=error";
+	if (result != PAM_SUCCESS && result != PAM_AUTH_ERR)
+		ssh_auth_info = "";
+	char variable[64] = "PAM_SSH_AUTH_INFO_PATTERN=";
+	if (decisive_index >= 0)
+		snprintf(
+			variable + strlen(variable),
+			sizeof variable - strlen(variable),
+			"%d",
+			decisive_index
+			);
+	int ret;
+	if (
+		(ret = pam_putenv(pamh, result_variable)) != PAM_SUCCESS ||
+		(ret = pam_putenv(pamh, variable)) != PAM_SUCCESS ||
+		(ret = export_field_list(
+			pamh,
+			"PAM_SSH_AUTH_INFO_METHODS",
+			ssh_auth_info,
+			EXPORT_METHOD
+			)) != PAM_SUCCESS ||
+		(ret = export_field_list(
+			pamh,
+			"PAM_SSH_AUTH_INFO_KEY_TYPES",
+			ssh_auth_info,
+			EXPORT_KEY_TYPE
+			)) != PAM_SUCCESS
+		)
+		return ret;
+	return export_field_list(
+		pamh,
+		"PAM_SSH_AUTH_INFO_KEY_FINGERPRINTS",
+		ssh_auth_info,
+		EXPORT_KEY_FINGERPRINT
+		);
+}
+
+static int
+authenticate(
+	pam_handle_t *const pamh,
 	int argc,
 	char const **argv
 	) {
-	(void)flags;
 	/* Parse options.
 	 */
-	bool debug = false;
-	char const *disable = NULL;
-	char const *enable = NULL;
-	enum {
-		MATCH_ALL_OF,
-		MATCH_ANY_OF,
-		MATCH_NONE_OF
-	} match_style = MATCH_ALL_OF;
-	bool quiet_fail = false;
-	bool quiet_success = false;
-	unsigned recursion_limit = 100u;
-	for (; argc > 0; --argc, ++argv) {
-		if (strcmp(*argv, "all_of") == 0)
-			match_style = MATCH_ALL_OF;
-		else if (strcmp(*argv, "any_of") == 0)
-			match_style = MATCH_ANY_OF;
-		else if (strcmp(*argv, "debug") == 0)
-			debug = true;
-		else if (strncmp(*argv, "disable=", 8) == 0)
-			disable = *argv + 8;
-		else if (strncmp(*argv, "enable=", 7) == 0)
-			enable = *argv + 7;
-		else if (strcmp(*argv, "none_of") == 0)
-			match_style = MATCH_NONE_OF;
-		else if (strcmp(*argv, "quiet") == 0)
-			quiet_fail = quiet_success = true;
-		else if (strcmp(*argv, "quiet_fail") == 0)
-			quiet_fail = true;
-		else if (strcmp(*argv, "quiet_success") == 0)
-			quiet_success = true;
-		else if (strncmp(*argv, "recursion_limit=", 16) == 0)
-			recursion_limit = strtoul(*argv + 16, NULL, 0);
-		else
-			break;
-	}
+	struct pam_options options;
+	int const n_options = parse_pam_options(&options, argc, argv);
+	int const n_args = argc;
+	char const *const *const args = argv;
+	argc -= n_options;
+	argv += n_options;
+	uint64_t const start = options.stats ? now_nanoseconds() : 0u;
+	/* Collect the debugging messages of a sampled invocation to a log
+	 * record.
+	 */
+	bool const debug = options.debug && sample_log(options.log_sample);
+	struct log_record record;
+	struct log_record *const log = debug ? &record : NULL;
+	if (log)
+		log_record_init(log);
+	/* Every path from here on leaves through out so that the log record is
+	 * flushed and the match matrix and the counters are destroyed.
+	 */
+	int ret = PAM_IGNORE;
+	int decisive_index = -1;
+	char const *ssh_auth_info = NULL;
+	struct match_matrix matrix;
+	matrix.rows = NULL;
+	struct match_row_counters *counters = NULL;
 	/* Process options.
+	 * An invalid option value (such as a misspelled line count) must not
+	 * silently change the requirements.
 	 */
-	if (disable || enable) {
-		int ret;
+	if (options.invalid) {
+		pam_syslog(
+			pamh,
+			LOG_ERR,
+			"invalid option \"%s\"",
+			options.invalid
+			);
+		ret = PAM_SERVICE_ERR;
+		goto out;
+	}
+#ifndef TOKENS_MATCH_TRACE
+	if (options.trace)
+		pam_syslog(
+			pamh,
+			LOG_WARNING,
+			"trace option not supported"
+			" (built without --enable-matcher-stats)"
+			);
+#endif
+#ifndef TOKENS_MATCH_STATS
+	if (options.stats)
+		pam_syslog(
+			pamh,
+			LOG_WARNING,
+			"stats option counts no matching steps,"
+			" recursion depths or recursion limit exhaustions"
+			" (built without --enable-matcher-stats)"
+			);
+#endif
+	if (options.disable || options.enable) {
 		char const *service = NULL;
 		if ((ret = pam_get_item(
 			pamh,
 			PAM_SERVICE,
 			(void const **)&service
 			)) != PAM_SUCCESS)
-			return ret;
+			goto out;
+		ret = PAM_IGNORE;
 		if (!service || !*service) {
 			if (debug)
 				pam_syslog(pamh, LOG_DEBUG, "no service");
-			return PAM_IGNORE;
+			goto out;
 		}
-		if (disable && in_list(disable, ':', service)) {
+		if (options.disable && in_list(
+			options.disable,
+			':',
+			service
+			)) {
 			if (debug)
 				pam_syslog(
 					pamh,
@@ -147,11 +1051,15 @@ pam_sm_authenticate(
 					" for service %s"
 					" due to disable=%s",
 					service,
-					disable
+					options.disable
 					);
-			return PAM_IGNORE;
+			goto out;
 		}
-		if (enable && !in_list(enable, ':', service)) {
+		if (options.enable && !in_list(
+			options.enable,
+			':',
+			service
+			)) {
 			if (debug)
 				pam_syslog(
 					pamh,
@@ -160,14 +1068,14 @@ pam_sm_authenticate(
 					" for service %s"
 					" due to enable=%s",
 					service,
-					enable
+					options.enable
 					);
-			return PAM_IGNORE;
+			goto out;
 		}
 	}
 	/* Retrieve SSH authentication information.
 	 */
-	char const* ssh_auth_info = pam_getenv(pamh, "SSH_AUTH_INFO_0");
+	ssh_auth_info = pam_getenv(pamh, "SSH_AUTH_INFO_0");
 	if (!ssh_auth_info || !*ssh_auth_info) {
 		if (debug)
 			pam_syslog(
@@ -176,77 +1084,191 @@ pam_sm_authenticate(
 				!ssh_auth_info ? "no %s" : "empty %s",
 				"SSH_AUTH_INFO_0"
 				);
-		return PAM_IGNORE;
+		goto out;
 	}
-	/* Process SSH authentication information patterns.
+	/* Get the preprocessed SSH authentication information patterns.
 	 */
-	bool success = match_style != MATCH_ANY_OF;
-	for (; argc > 0; --argc, ++argv) {
-		bool matches = false;
-		for (char const *s = ssh_auth_info; *s; s = next_line(s)) {
-			bool const allow_prefix_match = true;
-			matches = first_line_tokens_match(
-				s,
-				*argv,
-				allow_prefix_match,
-				recursion_limit
-				);
-			if (debug)
-				pam_syslog(
-					pamh,
-					LOG_DEBUG,
-					"ssh auth info"
-					" line \"%.*s\""
-					" %s"
-					" pattern \"%s\"",
-					(int)strcspn(s, "\n"),
-					s,
-					matches ? "matches" : "does not match",
-					*argv
+	struct pattern_config *config = NULL;
+	if ((ret = get_pattern_config(
+		pamh,
+		&options,
+		n_args,
+		args,
+		n_options,
+		&config
+		)) != PAM_SUCCESS)
+		goto out;
+	if (log) {
+		for (int i = 0; i < argc; ++i) {
+			if (strcmp(argv[i], config->set.patterns[i]) != 0)
+				log_record_add(
+					log,
+					"pattern \"%s\" optimized to \"%s\"",
+					argv[i],
+					config->set.patterns[i]
 					);
-			if (matches)
-				break;
-		}
-		switch (match_style) {
-		case MATCH_ALL_OF:
-			if (matches)
-				continue;
-			success = false;
-			break;
-		case MATCH_ANY_OF:
-			if (!matches)
-				continue;
-			success = true;
-			break;
-		case MATCH_NONE_OF:
-			if (!matches)
-				continue;
-			success = false;
-			break;
 		}
-		break;
 	}
-	if (!(success ? quiet_success : quiet_fail)) {
-		char const *user = NULL;
-		if (pam_get_item(
+	/* Check SSH authentication information pattern complexities.
+	 */
+	if (config->complexities && !check_pattern_complexities(
+		pamh,
+		&options,
+		argc,
+		argv,
+		config->complexities,
+		measure_longest_line(ssh_auth_info)
+		)) {
+		ret = PAM_SERVICE_ERR;
+		goto out;
+	}
+	/* Process SSH authentication information patterns.
+	 */
+	char const *const ssh_auth_info_end =
+		ssh_auth_info + strlen(ssh_auth_info);
+	if (
+		!match_matrix_init(
+			&matrix,
+			(size_t)argc,
+			count_ssh_auth_info_lines(
+				ssh_auth_info,
+				ssh_auth_info_end
+				)
+			) ||
+		((options.stats || options.debug_timing) &&
+			!(counters = calloc(
+				(size_t)argc + 1u,
+				sizeof *counters
+				)))
+		) {
+		pam_syslog(pamh, LOG_CRIT, "out of memory");
+		ret = PAM_BUF_ERR;
+		goto out;
+	}
+	struct match_line_context context = {
+		pamh,
+		argv,
+		counters,
+		options.debug_timing ? NULL : log
+	};
+	struct pattern_set_hooks const hooks = {match_line_hook, &context};
+	/* Observe the evaluation only if something is collected so that
+	 * the plain evaluation does not pay for the hook.
+	 */
+	bool observe = counters || context.log || options.trace ||
+		config->set.any_regular_expressions;
+#ifdef ENABLE_USDT
+	observe = true;
+#endif
+#ifdef TOKENS_MATCH_TRACE
+	/* Record the matcher decision events to a ring buffer.
+	 */
+	struct tokens_match_trace_event trace_events[TOKENS_MATCH_TRACE_SIZE];
+	unsigned long const exhaustions = tokens_match_stats.exhaustions;
+	if (options.trace) {
+		tokens_match_trace.events = trace_events;
+		tokens_match_trace.n = 0u;
+	}
+#endif
+	/* With reordering, the decisive pattern is reported (and exported)
+	 * as without reordering.
+	 */
+	bool const success = pattern_set_evaluate(
+		&config->set,
+		&config->scratch,
+		observe ? &hooks : NULL,
+		&matrix,
+		ssh_auth_info,
+		ssh_auth_info_end,
+		!options.quiet_success || options.export,
+		!options.quiet_fail || options.export,
+		&decisive_index
+		);
+	ret = success ? PAM_SUCCESS : PAM_AUTH_ERR;
+#ifdef TOKENS_MATCH_TRACE
+	tokens_match_trace.events = NULL;
+	/* Log the trace only if the authentication fails or the recursion limit
+	 * is exhausted so that tracing costs next to nothing otherwise.
+	 */
+	if (options.trace && (
+		!success || tokens_match_stats.exhaustions != exhaustions
+		))
+		log_trace(pamh, trace_events, tokens_match_trace.n);
+#endif
+	if (log && options.debug_timing)
+		log_pattern_timings(log, &matrix, counters, argc, argv);
+	if (options.stats) {
+		struct pam_stats_counters total = {1u, success, 0u, 0u, 0u, 0u};
+		for (int i = 0; i < argc; ++i) {
+			struct pam_stats_counters const *const row =
+				&counters[i].stats;
+			total.steps += row->steps;
+			total.exhaustions += row->exhaustions;
+			if (total.max_depth < row->max_depth)
+				total.max_depth = row->max_depth;
+		}
+		total.nanoseconds = now_nanoseconds() - start;
+		record_stats(
 			pamh,
-			PAM_USER,
-			(void const **)&user
-			) != PAM_SUCCESS || user == NULL)
-			user = "(unknown)";
-		pam_syslog(
+			options.stats,
+			n_options,
+			n_args,
+			args,
+			&total,
+			counters
+			);
+	}
+out:
+	free(counters);
+	match_matrix_destroy(&matrix);
+	/* The result is logged quietly (only heading the debugging messages)
+	 * unless the patterns were evaluated.
+	 */
+	log_result(
+		pamh,
+		log,
+		ret == PAM_SUCCESS ? options.quiet_success :
+		ret == PAM_AUTH_ERR ? options.quiet_fail :
+		true,
+		ret,
+		decisive_index >= 0 ? argv[decisive_index] : NULL
+		);
+	/* The results are exported on every path so that no stale results of
+	 * an earlier invocation remain.
+	 */
+	if (options.export) {
+		int const export_ret = export_results(
 			pamh,
-			LOG_INFO,
-			"ssh auth info %s%s%s%s %s by user %s",
-			argc ? "pattern requirement" : "pattern requirements",
-			argc ? " \"" : "",
-			argc ? *argv : "",
-			argc ? "\""  : "",
-			success ? "met" : "not met",
-			user
+			ssh_auth_info,
+			ret,
+			decisive_index
 			);
+		if (export_ret != PAM_SUCCESS) {
+			pam_syslog(
+				pamh,
+				LOG_CRIT,
+				export_ret == PAM_BUF_ERR
+					? "out of memory"
+					: "cannot export results"
+				);
+			return export_ret;
+		}
 	}
-	return success ? PAM_SUCCESS : PAM_AUTH_ERR;
+	return ret;
+}
+
+int
+pam_sm_authenticate(
+	pam_handle_t *pamh,
+	int flags,
+	int argc,
+	char const **argv
+	) {
+	(void)flags;
+	PROBE3(authenticate__entry, pamh, argc, argv);
+	int const ret = authenticate(pamh, argc, argv);
+	PROBE2(authenticate__return, pamh, ret);
+	return ret;
 }
 
 int
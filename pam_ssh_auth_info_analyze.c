@@ -0,0 +1,299 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include "config.h"
+#endif
+
+#if !defined(_POSIX_C_SOURCE)
+#	define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include "pam_line.h"
+#include "pam_options.h"
+#include "pattern_complexity.h"
+#include "pattern_cost.h"
+#include "pattern_optimize.h"
+
+static void
+usage(FILE *const out, char const *const name) {
+	fprintf(
+		out,
+		"Usage: %s [-n <LENGTH>] [<FILE>]...\n"
+		"\n"
+		"Print the worst-case complexity analysis of"
+		" pam_ssh_auth_info.so patterns\n"
+		"in PAM configuration files"
+		" (such as /etc/pam.d/sshd).\n"
+		"\n"
+		"Options:\n"
+		"  -h         Show this help message and exit.\n"
+		"  -n LENGTH  The SSH authentication information line length"
+		" (default: 1024).\n",
+		name
+		);
+}
+
+static void
+print_bound(struct pattern_complexity_bound const *const bound) {
+	printf("O(");
+	if (!bound->degree && !bound->unbounded)
+		printf("1");
+	else if (!bound->unbounded)
+		printf(bound->degree == 1u ? "n" : "n^%u", bound->degree);
+	else if (!bound->degree)
+		printf("n^(%u * recursion_limit)", bound->unbounded);
+	else
+		printf(
+			"n^(%u + %u * recursion_limit)",
+			bound->degree,
+			bound->unbounded
+			);
+	printf(")");
+}
+
+/* Analyze the patterns on a PAM configuration line.
+ * Returns the number of patterns exceeding the complexity_limit option and
+ * invalid options or -1 on error.
+ */
+static int
+analyze_pam_line(
+	char const *const file_name,
+	unsigned long const line_number,
+	int argc,
+	char const *const *argv,
+	size_t const tokens_len
+	) {
+	static struct character_byte_set const pattern_separators = {1, "="};
+	static struct character_byte_set const token_separators = {1, " "};
+	for (; argc > 0 && !is_module_path(*argv); --argc, ++argv)
+		;
+	if (argc <= 0)
+		return 0;
+	struct pam_options options;
+	int const n = parse_pam_options(&options, --argc, ++argv);
+	int exceeding = 0;
+	/* The module rejects an invalid option like a too complex pattern.
+	 */
+	if (options.invalid) {
+		printf(
+			"%s:%lu: invalid option \"%s\"\n",
+			file_name,
+			line_number,
+			options.invalid
+			);
+		++exceeding;
+	}
+	for (int i = n; i < argc; ++i) {
+		/* Regular expression patterns (re:...) are bounded by
+		 * the match limit instead.
+		 */
+		if (strncmp(argv[i], "re:", 3) == 0) {
+			printf(
+				"%s:%lu: pattern \"%s\": regular expression"
+				" (re_match_limit = %u)\n",
+				file_name,
+				line_number,
+				argv[i],
+				options.re_match_limit
+				);
+			continue;
+		}
+		/* Analyze the optimized pattern like the module does.
+		 */
+		size_t const len = strlen(argv[i]);
+		char *const pattern = malloc(len + 1u);
+		if (!pattern) {
+			fprintf(stderr, "%s\n", strerror(errno));
+			return -1;
+		}
+		char *const pattern_end = optimize_pattern(
+			argv[i],
+			argv[i] + len,
+			&pattern_separators,
+			&token_separators,
+			pattern
+			);
+		*pattern_end = '\0';
+		struct pattern_complexity_info info;
+		struct pattern_cost_info cost;
+		estimate_pattern_cost(pattern, pattern_end, &cost);
+		analyze_pattern_complexity(
+			pattern,
+			pattern_end,
+			&pattern_separators,
+			&token_separators,
+			&info
+			);
+		size_t const steps = evaluate_pattern_complexity_bound(
+			&info.steps,
+			tokens_len,
+			options.recursion_limit
+			);
+		printf(
+			"%s:%lu: pattern \"%s\": ",
+			file_name,
+			line_number,
+			argv[i]
+			);
+		if (strcmp(argv[i], pattern) != 0)
+			printf("optimized \"%s\": ", pattern);
+		free(pattern);
+		print_bound(&info.steps);
+		printf(
+			", depth %u, cost %zu, steps <= %zu%s"
+			" (n = %zu, recursion_limit = %u)",
+			info.depth,
+			cost.cost,
+			steps,
+			steps == SIZE_MAX ? " (saturated)" : "",
+			tokens_len,
+			options.recursion_limit
+			);
+		if (options.complexity_limit && (
+			steps > options.complexity_limit
+			)) {
+			printf(
+				": exceeds complexity_limit=%zu",
+				options.complexity_limit
+				);
+			++exceeding;
+		}
+		else if (options.complexity_warn && (
+			steps > options.complexity_warn
+			))
+			printf(
+				": exceeds complexity_warn=%zu",
+				options.complexity_warn
+				);
+		printf("\n");
+	}
+	return exceeding;
+}
+
+/* Analyze a PAM configuration file.
+ * Returns the number of patterns exceeding the complexity_limit options and
+ * invalid options or -1 on error.
+ */
+static int
+analyze_pam_file(char const *const file_name, size_t const tokens_len) {
+	bool const is_stdin = strcmp(file_name, "-") == 0;
+	FILE *const in = is_stdin ? stdin : fopen(file_name, "r");
+	if (!in) {
+		fprintf(stderr, "%s: %s\n", file_name, strerror(errno));
+		return -1;
+	}
+	int exceeding = 0;
+	char *line = NULL;
+	size_t line_size = 0u;
+	char *logical_line = NULL;
+	size_t logical_line_len = 0u;
+	unsigned long line_number = 0u;
+	unsigned long logical_line_number = 1u;
+	ssize_t len;
+	while ((len = getline(&line, &line_size, in)) >= 0) {
+		++line_number;
+		while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r'))
+			line[--len] = '\0';
+		bool const continued = len > 0 && line[len-1] == '\\';
+		if (continued)
+			line[--len] = ' ';
+		char *const p = realloc(
+			logical_line,
+			logical_line_len + (size_t)len + 1u
+			);
+		if (!p) {
+			fprintf(stderr, "%s: %s\n", file_name, strerror(errno));
+			exceeding = -1;
+			break;
+		}
+		logical_line = p;
+		memcpy(logical_line + logical_line_len, line, (size_t)len + 1u);
+		logical_line_len += (size_t)len;
+		if (continued)
+			continue;
+		char *argv[PAM_LINE_ARGS_MAX];
+		int const argc = split_pam_line(
+			logical_line,
+			argv,
+			PAM_LINE_ARGS_MAX
+			);
+		int const n = analyze_pam_line(
+			file_name,
+			logical_line_number,
+			argc,
+			(char const *const *)argv,
+			tokens_len
+			);
+		if (n < 0) {
+			exceeding = -1;
+			break;
+		}
+		exceeding += n;
+		logical_line_len = 0u;
+		logical_line_number = line_number + 1u;
+	}
+	if (ferror(in)) {
+		fprintf(stderr, "%s: %s\n", file_name, strerror(errno));
+		exceeding = -1;
+	}
+	free(logical_line);
+	free(line);
+	if (!is_stdin)
+		fclose(in);
+	return exceeding;
+}
+
+int
+main(int argc, char **argv) {
+	size_t tokens_len = 1024u;
+	int opt;
+	while ((opt = getopt(argc, argv, "hn:")) != -1) {
+		switch (opt) {
+		case 'h':
+			usage(stdout, argv[0]);
+			return 0;
+		case 'n':
+			tokens_len = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(stderr, argv[0]);
+			return 2;
+		}
+	}
+	static char *const default_files[] = {"-", NULL};
+	char *const *files = optind < argc ? argv + optind : default_files;
+	bool error = false;
+	bool exceeding = false;
+	for (; *files; ++files) {
+		int const n = analyze_pam_file(*files, tokens_len);
+		if (n < 0)
+			error = true;
+		else if (n > 0)
+			exceeding = true;
+	}
+	return error ? 2 : exceeding ? 1 : 0;
+}
@@ -0,0 +1,648 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include "config.h"
+#endif
+
+#if !defined(_POSIX_C_SOURCE)
+#	define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pam_line.h"
+#include "ssh_auth_info_match.h"
+
+/* The approximate size of a work item (a chunk of records).
+ */
+#define CHUNK_SIZE 65536u
+#define MAX_SETS 2
+#define MAX_THREADS 256
+
+/* The verdicts (see enum ssh_auth_info_match_result).
+ */
+#define N_VERDICTS 3
+
+static char const *const verdict_names[N_VERDICTS] = {
+	"accepted",
+	"rejected",
+	"ignored"
+};
+
+/* A memory mapped (or read) input file.
+ */
+struct audit_file {
+	char const *name;
+	char *data;
+	size_t size;
+	bool mapped;
+};
+
+/* A record whose verdicts differ between the pattern sets.
+ */
+struct audit_difference {
+	char const *record;
+	char const *record_end;
+	unsigned char verdicts[MAX_SETS];
+};
+
+/* A work item.
+ * The differences are collected per chunk so that they can be printed in
+ * the input order.
+ */
+struct audit_chunk {
+	struct audit_file const *file;
+	char const *begin;
+	char const *end;
+	struct audit_difference *differences;
+	size_t n_differences;
+	size_t differences_size;
+};
+
+struct audit;
+
+/* A worker thread.
+ *
+ * The chunks are distributed evenly to the workers in advance.
+ * Each worker owns a range of the chunk indexes (packed to a single 64-bit
+ * word so that it can be updated atomically) and takes chunks from the front
+ * of its range.
+ * A worker whose range is empty steals the back half of the range of
+ * another worker.
+ */
+struct audit_worker {
+	struct audit *audit;
+	pthread_t thread;
+	uint64_t range;
+	/* The record counts by the verdicts of the first and the second
+	 * pattern set.
+	 */
+	unsigned long counts[N_VERDICTS][N_VERDICTS];
+	bool error;
+};
+
+struct audit {
+	char delimiter;
+	bool list_differences;
+	int n_sets;
+	struct ssh_auth_info_match *sets[MAX_SETS];
+	struct audit_chunk *chunks;
+	size_t n_chunks;
+	struct audit_worker *workers;
+	size_t n_workers;
+};
+
+static void
+usage(FILE *const out, char const *const name) {
+	fprintf(
+		out,
+		"Usage: %s [-0dh] [-t <THREADS>] -p <ARGUMENTS>"
+		" [-p <ARGUMENTS>] [<FILE>]...\n"
+		"\n"
+		"Evaluate recorded SSH authentication information"
+		" (SSH_AUTH_INFO_0) records\n"
+		"against one or two sets of pam_ssh_auth_info.so"
+		" module arguments\n"
+		"and print the verdict counts and the differences"
+		" between the sets.\n"
+		"\n"
+		"Options:\n"
+		"  -0          The records are separated by NUL bytes"
+		" (default: newlines).\n"
+		"  -d          Print the records whose verdicts differ.\n"
+		"  -h          Show this help message and exit.\n"
+		"  -p ARGUMENTS\n"
+		"              The module arguments"
+		" (or a PAM configuration line).\n"
+		"  -t THREADS  The number of the worker threads"
+		" (default: the number of CPUs).\n",
+		name
+		);
+}
+
+static uint64_t
+pack_range(uint32_t const next, uint32_t const end) {
+	return (uint64_t)end << 32 | next;
+}
+
+/* Take the next chunk of a worker (or steal one from another worker).
+ * Returns false if there are no chunks left.
+ */
+static bool
+take_chunk(struct audit_worker *const worker, size_t *const chunk) {
+	struct audit *const audit = worker->audit;
+	size_t const self = (size_t)(worker - audit->workers);
+	for (size_t k = 0u; k < audit->n_workers; ++k) {
+		struct audit_worker *const victim =
+			&audit->workers[(self + k) % audit->n_workers];
+		uint64_t range = __atomic_load_n(
+			&victim->range,
+			__ATOMIC_ACQUIRE
+			);
+		for (;;) {
+			uint32_t const next = (uint32_t)range;
+			uint32_t const end = (uint32_t)(range >> 32);
+			if (next >= end)
+				break;
+			/* Take the first chunk of the own range or
+			 * the back half of the range of another worker.
+			 */
+			uint32_t const mid = victim == worker
+				? next
+				: next + (end - next) / 2u;
+			uint64_t const rest = victim == worker
+				? pack_range(next + 1u, end)
+				: pack_range(next, mid);
+			if (!__atomic_compare_exchange_n(
+				&victim->range,
+				&range,
+				rest,
+				false,
+				__ATOMIC_ACQ_REL,
+				__ATOMIC_ACQUIRE
+				))
+				continue;
+			if (victim != worker)
+				__atomic_store_n(
+					&worker->range,
+					pack_range(mid + 1u, end),
+					__ATOMIC_RELEASE
+					);
+			*chunk = mid;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool
+add_difference(
+	struct audit_chunk *const chunk,
+	char const *const record,
+	char const *const record_end,
+	int const *const verdicts
+	) {
+	if (chunk->n_differences >= chunk->differences_size) {
+		size_t const size = chunk->differences_size
+			? 2u * chunk->differences_size
+			: 16u;
+		struct audit_difference *const p = realloc(
+			chunk->differences,
+			size * sizeof *p
+			);
+		if (!p)
+			return false;
+		chunk->differences = p;
+		chunk->differences_size = size;
+	}
+	struct audit_difference *const difference =
+		&chunk->differences[chunk->n_differences++];
+	difference->record = record;
+	difference->record_end = record_end;
+	for (int i = 0; i < MAX_SETS; ++i)
+		difference->verdicts[i] = (unsigned char)verdicts[i];
+	return true;
+}
+
+/* Evaluate the records of a chunk.
+ * Returns false if out of memory.
+ */
+static bool
+evaluate_chunk(
+	struct audit_worker *const worker,
+	struct audit_chunk *const chunk
+	) {
+	struct audit const *const audit = worker->audit;
+	for (char const *s = chunk->begin; s < chunk->end; ) {
+		char const *const p = memchr(
+			s,
+			audit->delimiter,
+			(size_t)(chunk->end - s)
+			);
+		char const *const record = s;
+		char const *const record_end = p ? p : chunk->end;
+		s = p ? p + 1 : chunk->end;
+		/* With one pattern set, the verdicts of the second set are
+		 * the same.
+		 */
+		int verdicts[MAX_SETS] = {SSH_AUTH_INFO_MATCH_IGNORE};
+		for (int i = 0; i < audit->n_sets; ++i) {
+			verdicts[i] = ssh_auth_info_match_auth_info(
+				audit->sets[i],
+				record,
+				(size_t)(record_end - record)
+				);
+			if (verdicts[i] == SSH_AUTH_INFO_MATCH_ERROR)
+				return false;
+		}
+		for (int i = audit->n_sets; i < MAX_SETS; ++i)
+			verdicts[i] = verdicts[0];
+		++worker->counts[verdicts[0]][verdicts[1]];
+		if (
+			audit->list_differences &&
+			verdicts[0] != verdicts[1] &&
+			!add_difference(chunk, record, record_end, verdicts)
+			)
+			return false;
+	}
+	return true;
+}
+
+static void *
+run_worker(void *const arg) {
+	struct audit_worker *const worker = arg;
+	size_t chunk;
+	while (!worker->error && take_chunk(worker, &chunk)) {
+		if (!evaluate_chunk(worker, &worker->audit->chunks[chunk]))
+			worker->error = true;
+	}
+	return NULL;
+}
+
+/* Compile a pattern set (module arguments or a PAM configuration line).
+ * Returns NULL (and prints an error message) on error.
+ */
+static struct ssh_auth_info_match *
+compile_pattern_set(char const *const arguments) {
+	char *const line = strdup(arguments);
+	char **const args = calloc(PAM_LINE_ARGS_MAX, sizeof *args);
+	if (!line || !args) {
+		fprintf(stderr, "%s\n", strerror(errno));
+		free(args);
+		free(line);
+		return NULL;
+	}
+	int argc = split_pam_line(line, args, PAM_LINE_ARGS_MAX);
+	char const *const *argv = (char const *const *)args;
+	for (int i = 0; i < argc; ++i) {
+		if (is_module_path(argv[i])) {
+			argv += i + 1;
+			argc -= i + 1;
+			break;
+		}
+	}
+	char error[512];
+	struct ssh_auth_info_match *const match = ssh_auth_info_match_compile(
+		argc,
+		argv,
+		error,
+		sizeof error
+		);
+	if (!match)
+		fprintf(stderr, "%s\n", error);
+	free(args);
+	free(line);
+	return match;
+}
+
+/* Map an input file (or read the standard input).
+ * Returns false (and prints an error message) on error.
+ */
+static bool
+open_audit_file(struct audit_file *const file, char const *const name) {
+	file->name = name;
+	file->data = NULL;
+	file->size = 0u;
+	file->mapped = false;
+	if (strcmp(name, "-") == 0) {
+		size_t size = 0u;
+		for (;;) {
+			if (file->size + 1u >= size) {
+				size = size ? 2u * size : CHUNK_SIZE;
+				char *const data = realloc(file->data, size);
+				if (!data) {
+					fprintf(
+						stderr,
+						"%s\n",
+						strerror(errno)
+						);
+					return false;
+				}
+				file->data = data;
+			}
+			size_t const n = fread(
+				file->data + file->size,
+				1u,
+				size - file->size - 1u,
+				stdin
+				);
+			file->size += n;
+			if (n == 0u)
+				break;
+		}
+		file->data[file->size] = '\0';
+		if (ferror(stdin)) {
+			fprintf(stderr, "%s: %s\n", name, strerror(errno));
+			return false;
+		}
+		return true;
+	}
+	int const fd = open(name, O_RDONLY | O_CLOEXEC);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		fprintf(stderr, "%s: %s\n", name, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return false;
+	}
+	file->size = (size_t)st.st_size;
+	if (file->size > 0u) {
+		void *const p = mmap(
+			NULL,
+			file->size,
+			PROT_READ,
+			MAP_PRIVATE,
+			fd,
+			0
+			);
+		if (p == MAP_FAILED) {
+			fprintf(stderr, "%s: %s\n", name, strerror(errno));
+			close(fd);
+			return false;
+		}
+		posix_madvise(p, file->size, POSIX_MADV_SEQUENTIAL);
+		file->data = p;
+		file->mapped = true;
+	}
+	close(fd);
+	return true;
+}
+
+static void
+close_audit_file(struct audit_file *const file) {
+	if (file->mapped)
+		munmap(file->data, file->size);
+	else
+		free(file->data);
+}
+
+/* Split the files to chunks of whole records.
+ * Returns false if out of memory or if there are too many chunks.
+ */
+static bool
+split_audit_files(
+	struct audit *const audit,
+	struct audit_file const *const files,
+	size_t const n_files
+	) {
+	size_t size = 0u;
+	for (size_t i = 0u; i < n_files; ++i) {
+		char const *const data = files[i].data;
+		char const *const data_end = data + files[i].size;
+		for (char const *s = data; s < data_end; ) {
+			char const *end = data_end;
+			if ((size_t)(data_end - s) > CHUNK_SIZE) {
+				char const *const p = memchr(
+					s + CHUNK_SIZE,
+					audit->delimiter,
+					(size_t)(data_end - s) - CHUNK_SIZE
+					);
+				if (p)
+					end = p + 1;
+			}
+			if (audit->n_chunks >= size) {
+				size = size ? 2u * size : 64u;
+				if (size > UINT32_MAX)
+					return false;
+				struct audit_chunk *const p = realloc(
+					audit->chunks,
+					size * sizeof *p
+					);
+				if (!p)
+					return false;
+				audit->chunks = p;
+			}
+			struct audit_chunk *const chunk =
+				&audit->chunks[audit->n_chunks++];
+			memset(chunk, 0, sizeof *chunk);
+			chunk->file = &files[i];
+			chunk->begin = s;
+			chunk->end = end;
+			s = end;
+		}
+	}
+	return true;
+}
+
+static void
+print_record(char const *s, char const *const end) {
+	for (; s < end; ++s) {
+		if (*s == '\n')
+			printf("\\n");
+		else if (*s == '\\')
+			printf("\\\\");
+		else
+			putchar(*s);
+	}
+}
+
+static void
+print_audit(struct audit const *const audit) {
+	unsigned long counts[N_VERDICTS][N_VERDICTS] = {{0u}};
+	unsigned long n_records = 0u;
+	for (size_t w = 0u; w < audit->n_workers; ++w) {
+		for (int i = 0; i < N_VERDICTS; ++i) {
+			for (int j = 0; j < N_VERDICTS; ++j) {
+				counts[i][j] += audit->workers[w].counts[i][j];
+				n_records += audit->workers[w].counts[i][j];
+			}
+		}
+	}
+	if (audit->list_differences) {
+		for (size_t k = 0u; k < audit->n_chunks; ++k) {
+			struct audit_chunk const *const chunk =
+				&audit->chunks[k];
+			for (size_t i = 0u; i < chunk->n_differences; ++i) {
+				struct audit_difference const *const d =
+					&chunk->differences[i];
+				printf(
+					"%s:%zu: %s, %s: ",
+					chunk->file->name,
+					(size_t)(d->record - chunk->file->data),
+					verdict_names[d->verdicts[0]],
+					verdict_names[d->verdicts[1]]
+					);
+				print_record(d->record, d->record_end);
+				printf("\n");
+			}
+		}
+	}
+	printf("%lu records\n", n_records);
+	for (int set = 0; set < audit->n_sets; ++set) {
+		printf("set %c:", 'A' + set);
+		for (int v = 0; v < N_VERDICTS; ++v) {
+			unsigned long n = 0u;
+			for (int other = 0; other < N_VERDICTS; ++other)
+				n += set ? counts[other][v] : counts[v][other];
+			printf(" %lu %s%s", n, verdict_names[v],
+				v + 1 < N_VERDICTS ? "," : "\n");
+		}
+	}
+	for (int i = 0; audit->n_sets > 1 && i < N_VERDICTS; ++i) {
+		for (int j = 0; j < N_VERDICTS; ++j) {
+			if (i != j)
+				printf(
+					"%s by A, %s by B: %lu\n",
+					verdict_names[i],
+					verdict_names[j],
+					counts[i][j]
+					);
+		}
+	}
+}
+
+int
+main(int argc, char **argv) {
+	static struct audit audit = {'\n', false, 0, {0}, NULL, 0u, NULL, 0u};
+	char const *arguments[MAX_SETS];
+	long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	int opt;
+	while ((opt = getopt(argc, argv, "0dhp:t:")) != -1) {
+		switch (opt) {
+		case '0':
+			audit.delimiter = '\0';
+			break;
+		case 'd':
+			audit.list_differences = true;
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			return 0;
+		case 'p':
+			if (audit.n_sets >= MAX_SETS) {
+				usage(stderr, argv[0]);
+				return 2;
+			}
+			arguments[audit.n_sets++] = optarg;
+			break;
+		case 't':
+			n_threads = strtol(optarg, NULL, 0);
+			break;
+		default:
+			usage(stderr, argv[0]);
+			return 2;
+		}
+	}
+	if (!audit.n_sets) {
+		usage(stderr, argv[0]);
+		return 2;
+	}
+	static char *const default_files[] = {"-", NULL};
+	char *const *const names =
+		optind < argc ? argv + optind : default_files;
+	size_t n_files = 0u;
+	while (names[n_files])
+		++n_files;
+	struct audit_file *const files = calloc(n_files, sizeof *files);
+	bool error = !files;
+	if (error)
+		fprintf(stderr, "%s\n", strerror(errno));
+	for (int i = 0; !error && i < audit.n_sets; ++i)
+		error = !(audit.sets[i] = compile_pattern_set(arguments[i]));
+	size_t n_opened = 0u;
+	for (; !error && n_opened < n_files; ++n_opened)
+		error = !open_audit_file(&files[n_opened], names[n_opened]);
+	if (!error && !split_audit_files(&audit, files, n_files)) {
+		fprintf(stderr, "%s\n", strerror(errno ? errno : ENOMEM));
+		error = true;
+	}
+	/* Start the workers with evenly distributed chunks.
+	 */
+	if (n_threads < 1)
+		n_threads = 1;
+	if (n_threads > MAX_THREADS)
+		n_threads = MAX_THREADS;
+	if ((size_t)n_threads > audit.n_chunks)
+		n_threads = audit.n_chunks ? (long)audit.n_chunks : 1;
+	if (!error && !(audit.workers = calloc(
+		(size_t)n_threads,
+		sizeof *audit.workers
+		))) {
+		fprintf(stderr, "%s\n", strerror(errno));
+		error = true;
+	}
+	for (size_t w = 0u; !error && w < (size_t)n_threads; ++w) {
+		struct audit_worker *const worker = &audit.workers[w];
+		worker->audit = &audit;
+		size_t const n_workers = (size_t)n_threads;
+		worker->range = pack_range(
+			(uint32_t)(audit.n_chunks * w / n_workers),
+			(uint32_t)(audit.n_chunks * (w + 1u) / n_workers)
+			);
+		audit.n_workers = w + 1u;
+	}
+	size_t n_started = 0u;
+	for (; !error && n_started < audit.n_workers; ++n_started) {
+		int const rc = pthread_create(
+			&audit.workers[n_started].thread,
+			NULL,
+			run_worker,
+			&audit.workers[n_started]
+			);
+		if (rc) {
+			fprintf(stderr, "%s\n", strerror(rc));
+			error = true;
+			/* Let the started workers finish the work.
+			 */
+			break;
+		}
+	}
+	for (size_t w = 0u; w < n_started; ++w) {
+		pthread_join(audit.workers[w].thread, NULL);
+		if (audit.workers[w].error) {
+			fprintf(stderr, "%s\n", strerror(ENOMEM));
+			error = true;
+		}
+	}
+	bool differences = false;
+	if (!error) {
+		print_audit(&audit);
+		for (int i = 0; i < N_VERDICTS; ++i) {
+			for (size_t w = 0u; w < audit.n_workers; ++w)
+				differences = differences ||
+					audit.workers[w].counts[i][
+						(i + 1) % N_VERDICTS
+						] ||
+					audit.workers[w].counts[i][
+						(i + 2) % N_VERDICTS
+						];
+		}
+	}
+	free(audit.workers);
+	for (size_t k = 0u; k < audit.n_chunks; ++k)
+		free(audit.chunks[k].differences);
+	free(audit.chunks);
+	for (size_t i = 0u; i < n_opened; ++i)
+		close_audit_file(&files[i]);
+	free(files);
+	for (int i = 0; i < audit.n_sets; ++i)
+		ssh_auth_info_match_free(audit.sets[i]);
+	return error ? 2 : differences ? 1 : 0;
+}
@@ -0,0 +1,400 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include "config.h"
+#endif
+
+#if !defined(_POSIX_C_SOURCE)
+#	define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#if defined(HAVE_SECURITY_PAM_APPL_H) || !defined(PACKAGE_NAME)
+#	include <security/pam_appl.h>
+#endif
+#if defined(HAVE_SECURITY_PAM_MODULES_H) || !defined(PACKAGE_NAME)
+#	include <security/pam_modules.h>
+#endif
+
+#include "pam_shim.h"
+
+/* The maximum number of module arguments.
+ */
+#define MAX_ARGS 8
+
+struct bench_scenario {
+	char const *name;
+	char const *service;
+	char const *argv[MAX_ARGS];
+};
+
+struct bench_mode {
+	char const *name;
+	char const *flag;
+};
+
+struct bench_ssh_auth_info {
+	char const *name;
+	/* The lines with keys generated from the prefixes (the encoded key
+	 * types) and the lengths.
+	 */
+	struct {
+		char const *prefix;
+		size_t key_len;
+	} lines[3];
+};
+
+/* Representative /etc/pam.d/sshd argument vectors.
+ */
+static struct bench_scenario const scenarios[] = {
+	{"sk", "sshd", {"publickey=*sk-*@openssh.com", NULL}},
+	{
+		"sk-or-other",
+		"sshd",
+		{
+			"publickey=*sk-*@openssh.com",
+			"publickey=!(*sk-*@openssh.com)",
+			NULL
+		}
+	},
+	{"at_least", "sshd", {"at_least=2", "publickey", NULL}},
+	{
+		"enable",
+		"sshd",
+		{
+			"enable=login:sshd:su",
+			"publickey=@(ssh-ed25519|sk-ssh-ed25519@openssh.com)=*",
+			"keyboard-interactive",
+			NULL
+		}
+	},
+	{
+		"disabled",
+		"sshd",
+		{
+			"disable=login:sshd:su",
+			"publickey=ssh-ed25519=*",
+			NULL
+		}
+	},
+	{
+		"none_of",
+		"sshd",
+		{"none_of", "password", "publickey=ssh-rsa=*", NULL}
+	},
+	{NULL, NULL, {NULL}}
+};
+
+static struct bench_mode const modes[] = {
+	{"default", NULL},
+	{"debug", "debug"},
+	{"debug=timing", "debug=timing"},
+	{"export", "export"},
+	{"log_sample", "log_sample=100"},
+	{"quiet", "quiet"},
+	{"quiet_fail", "quiet_fail"},
+	{NULL, NULL}
+};
+
+static struct bench_ssh_auth_info const ssh_auth_infos[] = {
+	{
+		"ed25519+kbd",
+		{
+			{
+				"publickey ssh-ed25519"
+				" AAAAC3NzaC1lZDI1NTE5AAAAI",
+				68u
+			},
+			{"keyboard-interactive/pam", 0u},
+			{NULL, 0u}
+		}
+	},
+	{
+		"rsa+sk",
+		{
+			{
+				"publickey ssh-rsa"
+				" AAAAB3NzaC1yc2EAAAADAQABAAACAQ",
+				716u
+			},
+			{
+				"publickey sk-ssh-ed25519@openssh.com"
+				" AAAAGnNrLXNzaC1lZDI1NTE5QG9wZW5zc2guY29t",
+				124u
+			},
+			{NULL, 0u}
+		}
+	},
+	{NULL, {{NULL, 0u}}}
+};
+
+static void
+usage(FILE *const out, char const *const name) {
+	fprintf(
+		out,
+		"Usage: %s [-k <CALLS>] [-n <ITERATIONS>] [-v]\n"
+		"\n"
+		"Benchmark pam_sm_authenticate of pam_ssh_auth_info"
+		" with representative\n"
+		"arguments and SSH authentication information"
+		" using a PAM library stand-in.\n"
+		"\n"
+		"Options:\n"
+		"  -h             Show this help message and exit.\n"
+		"  -k CALLS       The number of calls per PAM handle"
+		" (default: 1).\n"
+		"  -n ITERATIONS  The number of calls per scenario, mode and"
+		" SSH authentication\n"
+		"                 information (default: 10000).\n"
+		"  -v             Print the syslog messages of the first PAM"
+		" handle to stderr.\n",
+		name
+		);
+}
+
+static unsigned long
+now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long)ts.tv_sec * 1000000000ul +
+		(unsigned long)ts.tv_nsec;
+}
+
+/* Build the SSH_AUTH_INFO_0 environment variable.
+ * The keys are generated by appending pseudo-random base64 character bytes.
+ * Returns a string which must be freed with free or NULL if out of memory.
+ */
+static char *
+build_ssh_auth_info(struct bench_ssh_auth_info const *const info) {
+	static char const base64[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+		"abcdefghijklmnopqrstuvwxyz"
+		"0123456789+/";
+	static char const name[] = "SSH_AUTH_INFO_0=";
+	size_t size = sizeof name;
+	for (size_t i = 0u; info->lines[i].prefix; ++i) {
+		size += strlen(info->lines[i].prefix) +
+			info->lines[i].key_len + 1u;
+	}
+	char *const s = malloc(size);
+	if (!s)
+		return NULL;
+	char *p = s;
+	unsigned long state = 1u;
+	memcpy(p, name, sizeof name - 1u);
+	p += sizeof name - 1u;
+	for (size_t i = 0u; info->lines[i].prefix; ++i) {
+		char const *const prefix = info->lines[i].prefix;
+		size_t const prefix_len = strlen(prefix);
+		memcpy(p, prefix, prefix_len);
+		p += prefix_len;
+		if (info->lines[i].key_len) {
+			char const *const key = strrchr(prefix, ' ') + 1;
+			size_t const key_prefix_len =
+				(size_t)(prefix + prefix_len - key);
+			for (
+				size_t j = key_prefix_len;
+				j < info->lines[i].key_len;
+				++j
+				) {
+				state = (state * 1103515245ul + 12345ul) &
+					0xFFFFFFFFul;
+				*p++ = base64[(state >> 16) % 64u];
+			}
+		}
+		*p++ = '\n';
+	}
+	*p = '\0';
+	return s;
+}
+
+static int
+compare_ns(void const *const a, void const *const b) {
+	unsigned long const x = *(unsigned long const *)a;
+	unsigned long const y = *(unsigned long const *)b;
+	return x < y ? -1 : x > y;
+}
+
+static char const *
+result_name(int const result) {
+	switch (result) {
+	case PAM_SUCCESS:
+		return "success";
+	case PAM_AUTH_ERR:
+		return "auth_err";
+	case PAM_IGNORE:
+		return "ignore";
+	default:
+		return "error";
+	}
+}
+
+/* Benchmark pam_sm_authenticate calls.
+ * A PAM handle is used for calls calls (like for the auth, account and
+ * session module types of a SSH session).
+ * Returns false if out of memory.
+ */
+static bool
+bench(
+	struct bench_scenario const *const scenario,
+	struct bench_mode const *const mode,
+	char const *const ssh_auth_info,
+	char const *const ssh_auth_info_name,
+	unsigned long const iterations,
+	unsigned long const calls,
+	bool const verbose,
+	unsigned long *const ns
+	) {
+	char const *argv[MAX_ARGS + 1];
+	int argc = 0;
+	if (mode->flag)
+		argv[argc++] = mode->flag;
+	for (size_t i = 0u; scenario->argv[i]; ++i)
+		argv[argc++] = scenario->argv[i];
+	argv[argc] = NULL;
+	int result = PAM_SUCCESS;
+	unsigned long syslog_count = 0u;
+	unsigned long total_ns = 0u;
+	pam_handle_t *pamh = NULL;
+	for (unsigned long i = 0u; i < iterations; ++i) {
+		if (!pamh) {
+			pamh = pam_shim_start(
+				scenario->service,
+				"user",
+				verbose && i == 0u ? stderr : NULL
+				);
+			if (!pamh || pam_putenv(
+				pamh,
+				ssh_auth_info
+				) != PAM_SUCCESS) {
+				if (pamh)
+					pam_shim_end(pamh, PAM_BUF_ERR);
+				return false;
+			}
+		}
+		unsigned long const start = now_ns();
+		result = pam_sm_authenticate(pamh, 0, argc, argv);
+		ns[i] = now_ns() - start;
+		total_ns += ns[i];
+		if ((i + 1u) % calls == 0u || i + 1u == iterations) {
+			syslog_count += pam_shim_syslog_count(pamh);
+			pam_shim_end(pamh, result);
+			pamh = NULL;
+		}
+	}
+	qsort(ns, iterations, sizeof *ns, compare_ns);
+	printf(
+		"%-12s %-12s %-12s %-8s %8lu %8lu %8lu %8lu %10.0f %6.2f\n",
+		scenario->name,
+		mode->name,
+		ssh_auth_info_name,
+		result_name(result),
+		ns[(iterations - 1u) * 50u / 100u],
+		ns[(iterations - 1u) * 90u / 100u],
+		ns[(iterations - 1u) * 99u / 100u],
+		ns[iterations - 1u],
+		total_ns ? (double)iterations * 1e9 / (double)total_ns : 0.0,
+		(double)syslog_count / (double)iterations
+		);
+	return true;
+}
+
+int
+main(int argc, char **argv) {
+	unsigned long calls = 1u;
+	unsigned long iterations = 10000u;
+	bool verbose = false;
+	int opt;
+	while ((opt = getopt(argc, argv, "hk:n:v")) != -1) {
+		switch (opt) {
+		case 'h':
+			usage(stdout, argv[0]);
+			return 0;
+		case 'k':
+			calls = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			iterations = strtoul(optarg, NULL, 0);
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		default:
+			usage(stderr, argv[0]);
+			return 2;
+		}
+	}
+	if (!calls)
+		calls = 1u;
+	if (!iterations)
+		iterations = 1u;
+	unsigned long *const ns = malloc(iterations * sizeof *ns);
+	if (!ns) {
+		fprintf(stderr, "out of memory\n");
+		return 2;
+	}
+	printf(
+		"%-12s %-12s %-12s %-8s %8s %8s %8s %8s %10s %6s\n",
+		"scenario",
+		"mode",
+		"auth info",
+		"result",
+		"p50 ns",
+		"p90 ns",
+		"p99 ns",
+		"max ns",
+		"calls/s",
+		"logs"
+		);
+	int status = 0;
+	for (size_t i = 0u; ssh_auth_infos[i].name && !status; ++i) {
+		char *const ssh_auth_info =
+			build_ssh_auth_info(&ssh_auth_infos[i]);
+		if (!ssh_auth_info) {
+			status = 2;
+			break;
+		}
+		for (size_t j = 0u; scenarios[j].name && !status; ++j) {
+			for (size_t k = 0u; modes[k].name && !status; ++k) {
+				if (!bench(
+					&scenarios[j],
+					&modes[k],
+					ssh_auth_info,
+					ssh_auth_infos[i].name,
+					iterations,
+					calls,
+					verbose,
+					ns
+					))
+					status = 2;
+			}
+		}
+		free(ssh_auth_info);
+	}
+	if (status)
+		fprintf(stderr, "out of memory\n");
+	free(ns);
+	return status;
+}
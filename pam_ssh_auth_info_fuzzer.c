@@ -0,0 +1,279 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* A libFuzzer target hunting for slow pam_sm_authenticate inputs.
+ *
+ * The module source is included so that the matcher step counters
+ * (see TOKENS_MATCH_STATS in tokens_match.h) are shared.
+ * The step counts are reported to libFuzzer as extra counters and inputs
+ * exceeding WORK_BUDGET_PER_BYTE steps per input byte abort. Build with
+ *     clang -g -O2 -fsanitize=fuzzer,address -I. \
+ *         pam_ssh_auth_info_fuzzer.c pam_shim.c -ldl
+ *
+ * With PAM_SSH_AUTH_INFO_FUZZER_REPLAY, a main function replaying input
+ * files and directories (by default, the regression corpus in
+ * $srcdir/pam_ssh_auth_info_fuzzer_corpus) is built instead.
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include "config.h"
+#endif
+
+#if !defined(_POSIX_C_SOURCE)
+#	define _POSIX_C_SOURCE 200809L
+#endif
+
+#define TOKENS_MATCH_STATS
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PAM_SSH_AUTH_INFO_FUZZER_REPLAY
+#	include <dirent.h>
+#	include <time.h>
+#endif
+
+#include "pam_shim.h"
+#include "pam_ssh_auth_info.c"
+
+#ifndef WORK_BUDGET_PER_BYTE
+#	define WORK_BUDGET_PER_BYTE 10000u
+#endif
+
+/* The realistic input limits.
+ */
+#define MAX_INPUT_SIZE 4096u
+#define MAX_ARGS 32
+
+#if defined(__clang__) && defined(__linux__)
+/* Work buckets (a quarter of a power of two each) for the total work and
+ * the work per input byte.
+ * New buckets are new features to libFuzzer which therefore keeps inputs
+ * doing more work.
+ */
+__attribute__((section("__libfuzzer_extra_counters")))
+static uint8_t work_counters[2][128];
+
+static unsigned
+work_bucket(unsigned long const work) {
+	unsigned log2 = 0u;
+	while (log2 + 1u < CHAR_BIT * sizeof work && work >> (log2 + 1u))
+		++log2;
+	/* The two bits after the leading one select the quarter.
+	 */
+	unsigned const quarter =
+		log2 >= 2u ? (unsigned)(work >> (log2 - 2u)) & 3u : 0u;
+	unsigned const bucket = 4u * log2 + quarter;
+	return bucket < 128u ? bucket : 127u;
+}
+#endif
+
+/* Run pam_sm_authenticate with an input
+ *     SSH_AUTH_INFO_0 [\0 argument]...
+ * The fixed options quiet and complexity_limit=1000000 precede
+ * the arguments.
+ * Returns the matcher work (steps) or -1 if the input is rejected.
+ */
+static long
+run_pam_sm_authenticate(uint8_t const *const data, size_t const size) {
+	static char const *const fixed_args[] = {
+		"quiet",
+		"complexity_limit=1000000"
+	};
+	enum { N_FIXED_ARGS = sizeof fixed_args / sizeof *fixed_args };
+	if (size > MAX_INPUT_SIZE)
+		return -1;
+	/* Copy the input to add the terminating null character bytes.
+	 */
+	static char buffer[sizeof "SSH_AUTH_INFO_0=" + MAX_INPUT_SIZE];
+	memcpy(buffer, "SSH_AUTH_INFO_0=", 16u);
+	memcpy(buffer + 16, data, size);
+	buffer[16u + size] = '\0';
+	char const *argv[N_FIXED_ARGS + MAX_ARGS];
+	int argc = N_FIXED_ARGS;
+	memcpy(argv, fixed_args, sizeof fixed_args);
+	for (
+		char *p = memchr(buffer + 16, '\0', size + 1u);
+		p < buffer + 16 + size;
+		p += strlen(p)
+		) {
+		char const *const arg = ++p;
+		if (argc >= N_FIXED_ARGS + MAX_ARGS)
+			return -1;
+		/* The fixed limits must not be overridden or bypassed and
+		 * no files must be written.
+		 */
+		if (
+			strncmp(arg, "complexity_", 11) == 0 ||
+			strncmp(arg, "re:", 3) == 0 ||
+			strncmp(arg, "recursion_limit=", 16) == 0 ||
+			strncmp(arg, "stats=", 6) == 0
+			)
+			return -1;
+		argv[argc++] = arg;
+	}
+	pam_handle_t *const pamh = pam_shim_start("sshd", "user", NULL);
+	if (!pamh)
+		return -1;
+	if (pam_putenv(pamh, buffer) != PAM_SUCCESS) {
+		pam_shim_end(pamh, PAM_BUF_ERR);
+		return -1;
+	}
+	memset(&tokens_match_stats, 0, sizeof tokens_match_stats);
+	int const result = pam_sm_authenticate(pamh, 0, argc, argv);
+	pam_shim_end(pamh, result);
+	return (long)(
+		tokens_match_stats.calls +
+		tokens_match_stats.entities +
+		tokens_match_stats.compared
+		);
+}
+
+static bool
+work_exceeds_budget(unsigned long const work, size_t const size) {
+	return work > WORK_BUDGET_PER_BYTE * (unsigned long)(size ? size : 1u);
+}
+
+int
+LLVMFuzzerTestOneInput(uint8_t const *const data, size_t const size);
+
+int
+LLVMFuzzerTestOneInput(uint8_t const *const data, size_t const size) {
+	long const work = run_pam_sm_authenticate(data, size);
+	if (work < 0)
+		return -1;  /* Reject. */
+#if defined(__clang__) && defined(__linux__)
+	unsigned long const per_byte = (unsigned long)work / (size ? size : 1u);
+	work_counters[0][work_bucket((unsigned long)work)] = 1u;
+	work_counters[1][work_bucket(per_byte)] = 1u;
+#endif
+	if (work_exceeds_budget((unsigned long)work, size)) {
+		fprintf(
+			stderr,
+			"work %ld exceeds the budget of %u steps per byte"
+			" for %zu bytes\n",
+			work,
+			WORK_BUDGET_PER_BYTE,
+			size
+			);
+		abort();
+	}
+	return 0;  /* Accept. The input may be added to the corpus. */
+}
+
+#ifdef PAM_SSH_AUTH_INFO_FUZZER_REPLAY
+static unsigned long
+now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long)ts.tv_sec * 1000000000ul +
+		(unsigned long)ts.tv_nsec;
+}
+
+/* Replay an input file.
+ * Returns false if the file cannot be read or the input exceeds the work
+ * budget.
+ */
+static bool
+replay_file(char const *const path) {
+	static uint8_t data[MAX_INPUT_SIZE + 1u];
+	FILE *const in = fopen(path, "rb");
+	if (!in) {
+		perror(path);
+		return false;
+	}
+	size_t const size = fread(data, 1u, sizeof data, in);
+	bool const error = ferror(in);
+	fclose(in);
+	if (error) {
+		perror(path);
+		return false;
+	}
+	unsigned long const start = now_ns();
+	long const work = run_pam_sm_authenticate(data, size);
+	unsigned long const ns = now_ns() - start;
+	if (work < 0) {
+		fprintf(stderr, "%s: %zu bytes: rejected\n", path, size);
+		return true;
+	}
+	bool const exceeds = work_exceeds_budget((unsigned long)work, size);
+	fprintf(
+		stderr,
+		"%s: %zu bytes: work %ld (%lu per byte), %lu ns%s\n",
+		path,
+		size,
+		work,
+		(unsigned long)work / (size ? size : 1u),
+		ns,
+		exceeds ? ": exceeds the budget" : ""
+		);
+	return !exceeds;
+}
+
+/* Replay the input files in a directory.
+ */
+static bool
+replay_directory(char const *const path) {
+	DIR *const dir = opendir(path);
+	if (!dir)
+		return replay_file(path);
+	bool ok = true;
+	for (struct dirent *entry; (entry = readdir(dir));) {
+		if (entry->d_name[0] == '.')
+			continue;
+		size_t const size = strlen(path) + strlen(entry->d_name) + 2u;
+		char *const file = malloc(size);
+		if (!file) {
+			ok = false;
+			break;
+		}
+		snprintf(file, size, "%s/%s", path, entry->d_name);
+		if (!replay_file(file))
+			ok = false;
+		free(file);
+	}
+	closedir(dir);
+	return ok;
+}
+
+int
+main(int argc, char **argv) {
+	bool ok = true;
+	if (argc > 1) {
+		for (int i = 1; i < argc; ++i) {
+			if (!replay_directory(argv[i]))
+				ok = false;
+		}
+	}
+	else {
+		char const *const srcdir = getenv("srcdir");
+		char const *const name = "pam_ssh_auth_info_fuzzer_corpus";
+		size_t const size = (srcdir ? strlen(srcdir) : 1u) +
+			strlen(name) + 2u;
+		char *const path = malloc(size);
+		if (!path)
+			return 1;
+		snprintf(path, size, "%s/%s", srcdir ? srcdir : ".", name);
+		ok = replay_directory(path);
+		free(path);
+	}
+	fprintf(stderr, ok ? "OK\n" : "FAILED\n");
+	return ok ? 0 : 1;
+}
+#endif  /* PAM_SSH_AUTH_INFO_FUZZER_REPLAY */
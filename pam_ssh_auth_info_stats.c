@@ -0,0 +1,284 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include "config.h"
+#endif
+
+#if !defined(_POSIX_C_SOURCE)
+#	define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include "pam_stats.h"
+
+#define DEFAULT_FILE "/run/pam_ssh_auth_info.stats"
+
+/* A snapshot of a stats slot.
+ */
+struct stats_entry {
+	enum pam_stats_slot_kind kind;
+	uint64_t key;
+	uint64_t parent;
+	uint32_t index;
+	struct pam_stats_counters counters;
+	char text[PAM_STATS_TEXT_SIZE];
+};
+
+static void
+usage(FILE *const out, char const *const name) {
+	fprintf(
+		out,
+		"Usage: %s [-j] [<FILE>]\n"
+		"\n"
+		"Print the counters of a pam_ssh_auth_info.so stats file"
+		" (default: %s).\n"
+		"\n"
+		"Options:\n"
+		"  -h  Show this help message and exit.\n"
+		"  -j  Print JSON instead of text.\n",
+		name,
+		DEFAULT_FILE
+		);
+}
+
+/* Take a snapshot of a slot.
+ * The counters are loaded atomically one by one.
+ * Returns false if the slot is not ready.
+ */
+static bool
+load_stats_entry(
+	struct pam_stats_slot const *const slot,
+	struct stats_entry *const entry
+	) {
+#ifdef PAM_STATS_SUPPORTED
+	struct pam_stats_counters const *const p = &slot->counters;
+	struct pam_stats_counters *const counters = &entry->counters;
+	entry->kind = (enum pam_stats_slot_kind)__atomic_load_n(
+		&slot->kind,
+		__ATOMIC_ACQUIRE
+		);
+	if (!entry->kind)
+		return false;
+	entry->key = slot->key;
+	entry->parent = slot->parent;
+	entry->index = slot->index;
+	memcpy(entry->text, slot->text, sizeof entry->text);
+	entry->text[sizeof entry->text - 1u] = '\0';
+	counters->evaluations =
+		__atomic_load_n(&p->evaluations, __ATOMIC_RELAXED);
+	counters->matches = __atomic_load_n(&p->matches, __ATOMIC_RELAXED);
+	counters->nanoseconds =
+		__atomic_load_n(&p->nanoseconds, __ATOMIC_RELAXED);
+	counters->steps = __atomic_load_n(&p->steps, __ATOMIC_RELAXED);
+	counters->max_depth = __atomic_load_n(&p->max_depth, __ATOMIC_RELAXED);
+	counters->exhaustions =
+		__atomic_load_n(&p->exhaustions, __ATOMIC_RELAXED);
+	return true;
+#else
+	(void)slot;
+	(void)entry;
+	return false;
+#endif
+}
+
+static void
+print_json_string(char const *s) {
+	putchar('"');
+	for (; *s; ++s) {
+		unsigned char const c = (unsigned char)*s;
+		if (c == '"' || c == '\\')
+			printf("\\%c", c);
+		else if (c < 0x20u)
+			printf("\\u%04x", c);
+		else
+			putchar(c);
+	}
+	putchar('"');
+}
+
+static void
+print_counters(
+	struct pam_stats_counters const *const counters,
+	bool const json
+	) {
+	printf(
+		json
+			? "\"evaluations\": %" PRIu64
+			  ", \"matches\": %" PRIu64
+			  ", \"nanoseconds\": %" PRIu64
+			  ", \"steps\": %" PRIu64
+			  ", \"max_depth\": %" PRIu64
+			  ", \"exhaustions\": %" PRIu64
+			: "evaluations %" PRIu64
+			  ", matches %" PRIu64
+			  ", nanoseconds %" PRIu64
+			  ", steps %" PRIu64
+			  ", max_depth %" PRIu64
+			  ", exhaustions %" PRIu64,
+		counters->evaluations,
+		counters->matches,
+		counters->nanoseconds,
+		counters->steps,
+		counters->max_depth,
+		counters->exhaustions
+		);
+}
+
+static void
+print_pattern(
+	struct stats_entry const *const pattern,
+	bool const first,
+	bool const json
+	) {
+	if (json) {
+		printf(
+			"%s\n    {\"index\": %" PRIu32 ", \"pattern\": ",
+			first ? "" : ",",
+			pattern->index
+			);
+		print_json_string(pattern->text);
+		printf(", ");
+		print_counters(&pattern->counters, json);
+		printf("}");
+	}
+	else {
+		printf(
+			"  pattern %" PRIu32 " \"%s\": ",
+			pattern->index,
+			pattern->text
+			);
+		print_counters(&pattern->counters, json);
+		printf("\n");
+	}
+}
+
+/* Print the configurations followed by their patterns in index order.
+ */
+static void
+print_stats_entries(
+	struct stats_entry const *const entries,
+	size_t const n,
+	bool const json
+	) {
+	bool first_config = true;
+	if (json)
+		printf("[");
+	for (size_t i = 0u; i < n; ++i) {
+		struct stats_entry const *const config = &entries[i];
+		if (config->kind != PAM_STATS_CONFIG)
+			continue;
+		if (json) {
+			printf("%s\n  {\"config\": ", first_config ? "" : ",");
+			print_json_string(config->text);
+			printf(", ");
+			print_counters(&config->counters, json);
+			printf(", \"patterns\": [");
+		}
+		else {
+			printf("config \"%s\": ", config->text);
+			print_counters(&config->counters, json);
+			printf("\n");
+		}
+		first_config = false;
+		bool first_pattern = true;
+		for (uint32_t index = 0u, next = 0u; next != UINT32_MAX; ) {
+			next = UINT32_MAX;
+			for (size_t j = 0u; j < n; ++j) {
+				struct stats_entry const *const pattern =
+					&entries[j];
+				if (
+					pattern->kind != PAM_STATS_PATTERN ||
+					pattern->parent != config->key ||
+					pattern->index < index
+					)
+					continue;
+				if (pattern->index > index) {
+					if (next > pattern->index)
+						next = pattern->index;
+					continue;
+				}
+				print_pattern(pattern, first_pattern, json);
+				first_pattern = false;
+			}
+			index = next;
+		}
+		if (json)
+			printf("%s]}", first_pattern ? "" : "\n  ");
+	}
+	if (json)
+		printf("%s]\n", first_config ? "" : "\n");
+}
+
+int
+main(int argc, char **argv) {
+	bool json = false;
+	int opt;
+	while ((opt = getopt(argc, argv, "hj")) != -1) {
+		switch (opt) {
+		case 'h':
+			usage(stdout, argv[0]);
+			return 0;
+		case 'j':
+			json = true;
+			break;
+		default:
+			usage(stderr, argv[0]);
+			return 2;
+		}
+	}
+	if (argc - optind > 1) {
+		usage(stderr, argv[0]);
+		return 2;
+	}
+	char const *const file_name =
+		optind < argc ? argv[optind] : DEFAULT_FILE;
+	struct pam_stats_file *const file = open_pam_stats_file(
+		file_name,
+		false
+		);
+	if (!file) {
+		fprintf(stderr, "%s: %s\n", file_name, strerror(errno));
+		return 1;
+	}
+	struct stats_entry *const entries = malloc(
+		PAM_STATS_SLOTS * sizeof *entries
+		);
+	if (!entries) {
+		fprintf(stderr, "%s\n", strerror(errno));
+		close_pam_stats_file(file);
+		return 1;
+	}
+	size_t n = 0u;
+	for (size_t i = 0u; i < PAM_STATS_SLOTS; ++i) {
+		if (load_stats_entry(&file->slots[i], &entries[n]))
+			++n;
+	}
+	close_pam_stats_file(file);
+	print_stats_entries(entries, n, json);
+	free(entries);
+	return 0;
+}
@@ -0,0 +1,848 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#undef NDEBUG
+
+#ifdef HAVE_CONFIG_H
+#	include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_SECURITY_PAM_APPL_H) || !defined(PACKAGE_NAME)
+#	include <security/pam_appl.h>
+#endif
+#if defined(HAVE_SECURITY_PAM_MODULES_H) || !defined(PACKAGE_NAME)
+#	include <security/pam_modules.h>
+#endif
+
+#include "pam_shim.h"
+#include "pam_stats.h"
+
+/* The keys and their fingerprints (see ssh_key_fingerprint_test.c and
+ * ssh-keygen -l).
+ */
+#define ED25519_LINE \
+	"publickey ssh-ed25519 " \
+	"AAAAC3NzaC1lZDI1NTE5AAAAIFcUj3uRVCEk9OWUb1IbPOHxhEndD9ZEIxzOi7nTnuG6"
+#define ED25519_FINGERPRINT \
+	"SHA256:cEgpBWLBfsUtoOxw/erSilqq2JtOMT4QqmVccVNFmVs"
+#define RSA_LINE \
+	"publickey ssh-rsa " \
+	"AAAAB3NzaC1yc2EAAAADAQABAAAAgQDCWFcbV28eFS9dEUhHSvABD3OMDx67iPkUrVP0" \
+	"TTkwMMxEjD2XyPsPcV8yFnWVKnmK8a5Op3GVQHCZUjcRB9wrgl3me+o5d0x6Qpq1leyB" \
+	"GTaD0YPSNSg9cS4Y5xGgryaN8fB0jOkQr9a7gzq3S5ncfQruWz2Nkw/pvYyi/phKDw=="
+#define RSA_FINGERPRINT \
+	"SHA256:6i4B8AMTOT5+VEk2mVQPph69cw3I50418wMeaUkUkF0"
+#define SK_LINE "publickey sk-ssh-ed25519@openssh.com AAAAGnNr"
+
+struct pam_ssh_auth_info_test_data {
+	char const *argv[4];
+	/* The SSH authentication information or NULL if not available.
+	 */
+	char const *ssh_auth_info;
+	int expected;
+};
+
+static struct pam_ssh_auth_info_test_data const test_data[] = {
+	{{"publickey", NULL}, ED25519_LINE, PAM_SUCCESS},
+	{{"publickey", NULL}, "password", PAM_AUTH_ERR},
+	{{"publickey", NULL}, NULL, PAM_IGNORE},
+	{
+		{"at_least=2", "publickey", NULL},
+		ED25519_LINE "\n" SK_LINE,
+		PAM_SUCCESS
+	},
+	{
+		{"at_least=2", "publickey", NULL},
+		ED25519_LINE "\npassword",
+		PAM_AUTH_ERR
+	},
+	{
+		{"at_least=2", "publickey", "password"},
+		ED25519_LINE "\npassword",
+		PAM_SUCCESS
+	},
+	/* A line is counted only once.
+	 */
+	{
+		{"at_least=2", "publickey", "publickey=ssh-ed25519=*"},
+		ED25519_LINE "\npassword",
+		PAM_AUTH_ERR
+	},
+	{{"at_least=0", "publickey", NULL}, "password", PAM_SUCCESS},
+	{
+		{"exactly=1", "publickey", NULL},
+		ED25519_LINE "\npassword",
+		PAM_SUCCESS
+	},
+	/* More matching lines than the count.
+	 */
+	{
+		{"exactly=1", "publickey", NULL},
+		ED25519_LINE "\n" SK_LINE,
+		PAM_AUTH_ERR
+	},
+	{
+		{"exactly=1", "publickey=*sk-*@openssh.com", "password"},
+		SK_LINE "\npassword",
+		PAM_AUTH_ERR
+	},
+	{{"exactly=1", "publickey", NULL}, "password", PAM_AUTH_ERR},
+	{{"exactly=0", "publickey", NULL}, "password", PAM_SUCCESS},
+	{{"exactly=0", "publickey", NULL}, ED25519_LINE, PAM_AUTH_ERR},
+	{
+		{"exactly=0x2", "publickey", NULL},
+		ED25519_LINE "\n" SK_LINE,
+		PAM_SUCCESS
+	},
+	/* An invalid count must not open authentication.
+	 */
+	{{"at_least=", "publickey", NULL}, "password", PAM_SERVICE_ERR},
+	{{"at_least=abc", "publickey", NULL}, "password", PAM_SERVICE_ERR},
+	{{"at_least=+1", "publickey", NULL}, "password", PAM_SERVICE_ERR},
+	{{"at_least= 1", "publickey", NULL}, "password", PAM_SERVICE_ERR},
+	{{"exactly=-1", "publickey", NULL}, "password", PAM_SERVICE_ERR},
+	{{"exactly=1x", "publickey", NULL}, ED25519_LINE, PAM_SERVICE_ERR},
+	{
+		{"exactly=99999999999999999999999", "publickey", NULL},
+		"password",
+		PAM_SERVICE_ERR
+	},
+	{{"at_least=abc", "publickey", NULL}, NULL, PAM_SERVICE_ERR},
+	/* Neither must an invalid limit.
+	 */
+	{
+		{"complexity_limit=abc", "publickey", NULL},
+		"password",
+		PAM_SERVICE_ERR
+	},
+	{
+		{"complexity_limit=10k", "publickey", NULL},
+		"password",
+		PAM_SERVICE_ERR
+	},
+	{{"complexity_warn=", "publickey", NULL}, "password", PAM_SERVICE_ERR},
+	{{"log_sample=-1", "publickey", NULL}, "password", PAM_SERVICE_ERR},
+	{
+		{"re_match_limit=1e6", "publickey", NULL},
+		"password",
+		PAM_SERVICE_ERR
+	},
+	{
+		{"recursion_limit=-1", "publickey", NULL},
+		ED25519_LINE,
+		PAM_SERVICE_ERR
+	},
+	{
+		{"recursion_limit=0x100000000", "publickey", NULL},
+		ED25519_LINE,
+		PAM_SERVICE_ERR
+	},
+	{
+		{"complexity_limit=0x100000", "publickey", NULL},
+		ED25519_LINE,
+		PAM_SUCCESS
+	},
+	{{"recursion_limit=010", "publickey", NULL}, ED25519_LINE, PAM_SUCCESS},
+#ifdef HAVE_PCRE2
+	/* Regular expressions match whole lines unless unanchored.
+	 */
+	{{"re:publickey ssh-ed25519", NULL}, ED25519_LINE, PAM_AUTH_ERR},
+	{{"re:ssh-ed25519 \\S+", NULL}, ED25519_LINE, PAM_AUTH_ERR},
+	{{"re:publickey ssh-ed25519 \\S+", NULL}, ED25519_LINE, PAM_SUCCESS},
+	{{"re:password|publickey .*", NULL}, ED25519_LINE, PAM_SUCCESS},
+	{
+		{"re_unanchored", "re:publickey ssh-ed25519", NULL},
+		ED25519_LINE,
+		PAM_SUCCESS
+	},
+	{
+		{"re_unanchored", "re:^ssh-ed25519", NULL},
+		ED25519_LINE,
+		PAM_AUTH_ERR
+	},
+	{{"re:(", NULL}, ED25519_LINE, PAM_SERVICE_ERR},
+#endif
+	{{NULL}, NULL, 0}
+};
+
+static int
+count_args(char const *const *const argv, int const max) {
+	int argc = 0;
+	while (argc < max && argv[argc])
+		++argc;
+	return argc;
+}
+
+/* Start a PAM handle with SSH authentication information (unless NULL).
+ * The syslog messages are written to the log file.
+ */
+static pam_handle_t *
+start(char const *const ssh_auth_info, FILE *const log) {
+	pam_handle_t *const pamh = pam_shim_start("sshd", "user", log);
+	assert(pamh);
+	if (ssh_auth_info) {
+		size_t const size = sizeof "SSH_AUTH_INFO_0=" +
+			strlen(ssh_auth_info);
+		char *const variable = malloc(size);
+		assert(variable);
+		snprintf(variable, size, "SSH_AUTH_INFO_0=%s", ssh_auth_info);
+		assert(pam_putenv(pamh, variable) == PAM_SUCCESS);
+		free(variable);
+	}
+	return pamh;
+}
+
+/* Call pam_sm_authenticate with a new PAM handle.
+ * The number of the syslog messages is stored to syslog_count unless NULL.
+ */
+static int
+authenticate(
+	char const *const *const argv,
+	int const argc,
+	char const *const ssh_auth_info,
+	unsigned long *const syslog_count
+	) {
+	pam_handle_t *const pamh = start(ssh_auth_info, stderr);
+	int const result = pam_sm_authenticate(
+		pamh,
+		0,
+		argc,
+		(char const **)argv
+		);
+	if (syslog_count)
+		*syslog_count = pam_shim_syslog_count(pamh);
+	pam_shim_end(pamh, result);
+	return result;
+}
+
+static void
+assert_env(
+	pam_handle_t *const pamh,
+	char const *const name,
+	char const *const expected
+	) {
+	char const *const actual = pam_getenv(pamh, name);
+	fprintf(stderr, "%s=%s\n", name, actual ? actual : "(null)");
+	assert(actual && strcmp(actual, expected) == 0);
+}
+
+/* Read the syslog messages from a temporary log file (see start) and copy
+ * them to stderr.
+ */
+static void
+read_log(FILE *const log, char *const text, size_t const size) {
+	rewind(log);
+	size_t const len = fread(text, 1u, size - 1u, log);
+	assert(!ferror(log) && feof(log));
+	text[len] = '\0';
+	fputs(text, stderr);
+	fclose(log);
+}
+
+struct pam_ssh_auth_info_reorder_test_data {
+	/* The match style and the patterns.
+	 */
+	char const *argv[4];
+	char const *ssh_auth_info;
+	int expected;
+	/* The expected decisive pattern index (in the argument order).
+	 */
+	char const *expected_pattern;
+};
+
+/* The reorder option must change neither the result nor the reported
+ * decisive pattern.
+ * The costly patterns are given first so that they are evaluated last.
+ */
+static struct pam_ssh_auth_info_reorder_test_data const
+	reorder_test_data[] = {
+	{
+		{"all_of", "publickey=*=*(*(A|AA)B)", "password", NULL},
+		ED25519_LINE,
+		PAM_AUTH_ERR,
+		"0"
+	},
+	{
+		{"all_of", "publickey=*=*(A|C|z)*", "publickey", "password"},
+		ED25519_LINE,
+		PAM_AUTH_ERR,
+		"2"
+	},
+	{
+		{"all_of", "publickey=*=*(A|C|z)*", "publickey", NULL},
+		ED25519_LINE,
+		PAM_SUCCESS,
+		""
+	},
+	{
+		{"any_of", "publickey=*=*(A|C|z)*", "publickey", NULL},
+		ED25519_LINE,
+		PAM_SUCCESS,
+		"0"
+	},
+	{
+		{"any_of", "publickey=*-cert-*=*", "password", "publickey"},
+		ED25519_LINE,
+		PAM_SUCCESS,
+		"2"
+	},
+	{
+		{"any_of", "publickey=*=*(*(A|AA)B)", "password", NULL},
+		ED25519_LINE,
+		PAM_AUTH_ERR,
+		""
+	},
+	{
+		{"none_of", "publickey=*=*(A|C|z)*", "publickey", NULL},
+		ED25519_LINE,
+		PAM_AUTH_ERR,
+		"0"
+	},
+	{
+		{"none_of", "publickey=*=*(*(A|AA)B)", "password", NULL},
+		ED25519_LINE,
+		PAM_SUCCESS,
+		""
+	},
+	{
+		{"at_least=2", "publickey=*=*(A|C|z)*", "publickey=sk-*", NULL},
+		ED25519_LINE "\n" SK_LINE,
+		PAM_SUCCESS,
+		""
+	},
+	{
+		{"at_least=3", "publickey=*=*(A|C|z)*", "publickey=sk-*", NULL},
+		ED25519_LINE "\n" SK_LINE,
+		PAM_AUTH_ERR,
+		""
+	},
+	{
+		{"exactly=1", "publickey=*=*(A|C|z)*", "publickey=sk-*", NULL},
+		ED25519_LINE "\n" SK_LINE,
+		PAM_AUTH_ERR,
+		""
+	},
+	{
+		{"exactly=2", "publickey=*=*(A|C|z)*", "publickey=sk-*", NULL},
+		ED25519_LINE "\n" SK_LINE,
+		PAM_SUCCESS,
+		""
+	},
+	{{NULL}, NULL, 0, NULL}
+};
+
+/* Call pam_sm_authenticate with the export option and optionally with
+ * the reorder option.
+ * The exported decisive pattern index and the syslog messages are stored to
+ * pattern and log_text.
+ */
+static int
+authenticate_reorder(
+	struct pam_ssh_auth_info_reorder_test_data const *const data,
+	bool const reorder,
+	char *const pattern,
+	size_t const pattern_size,
+	char *const log_text,
+	size_t const log_size
+	) {
+	char const *argv[6] = {"export"};
+	int argc = 1;
+	if (reorder)
+		argv[argc++] = "reorder";
+	for (int i = 0; i < 4 && data->argv[i]; ++i)
+		argv[argc++] = data->argv[i];
+	FILE *const log = tmpfile();
+	assert(log);
+	pam_handle_t *const pamh = start(data->ssh_auth_info, log);
+	int const result = pam_sm_authenticate(
+		pamh,
+		0,
+		argc,
+		(char const **)argv
+		);
+	char const *const value = pam_getenv(
+		pamh,
+		"PAM_SSH_AUTH_INFO_PATTERN"
+		);
+	assert(value && strlen(value) < pattern_size);
+	strcpy(pattern, value);
+	pam_shim_end(pamh, result);
+	read_log(log, log_text, log_size);
+	return result;
+}
+
+#ifdef PAM_STATS_SUPPORTED
+/* Check that a stats file counts the invocations and the pattern
+ * evaluations.
+ */
+static void
+check_stats(void) {
+	char file_name[] = "pam_ssh_auth_info_test.XXXXXX";
+	int const fd = mkstemp(file_name);
+	assert(fd >= 0);
+	close(fd);
+	char stats_option[sizeof file_name + 6u];
+	snprintf(stats_option, sizeof stats_option, "stats=%s", file_name);
+	char const *const argv[] = {stats_option, "publickey", "password"};
+	for (int i = 0; i < 3; ++i) {
+		unsigned long syslog_count;
+		assert(authenticate(
+			argv,
+			3,
+			ED25519_LINE "\n" SK_LINE,
+			&syslog_count
+			) == PAM_AUTH_ERR);
+#ifdef ENABLE_MATCHER_STATS
+		assert(syslog_count == 1u);
+#else
+		/* The failure message and the matcher stats warning.
+		 */
+		assert(syslog_count == 2u);
+#endif
+	}
+	struct pam_stats_file *const file = open_pam_stats_file(
+		file_name,
+		false
+		);
+	assert(file);
+	struct pam_stats_counters const *config = NULL;
+	struct pam_stats_counters const *patterns[2] = {NULL, NULL};
+	for (size_t i = 0u; i < PAM_STATS_SLOTS; ++i) {
+		struct pam_stats_slot const *const slot = &file->slots[i];
+		if (slot->kind == PAM_STATS_CONFIG) {
+			assert(!config);
+			config = &slot->counters;
+		}
+		else if (slot->kind == PAM_STATS_PATTERN) {
+			assert(slot->index < 2u && !patterns[slot->index]);
+			assert(strcmp(slot->text, argv[1u + slot->index]) == 0);
+			patterns[slot->index] = &slot->counters;
+		}
+	}
+	assert(config && patterns[0] && patterns[1]);
+	fprintf(
+		stderr,
+		"stats: config %lu/%lu, patterns %lu/%lu and %lu/%lu,"
+		" steps %lu\n",
+		(unsigned long)config->matches,
+		(unsigned long)config->evaluations,
+		(unsigned long)patterns[0]->matches,
+		(unsigned long)patterns[0]->evaluations,
+		(unsigned long)patterns[1]->matches,
+		(unsigned long)patterns[1]->evaluations,
+		(unsigned long)config->steps
+		);
+	/* The first pattern matches the first line and it is not evaluated
+	 * further but the second pattern is evaluated against both lines.
+	 */
+	assert(config->evaluations == 3u && config->matches == 0u);
+	assert(patterns[0]->evaluations == 3u && patterns[0]->matches == 3u);
+	assert(patterns[1]->evaluations == 6u && patterns[1]->matches == 0u);
+#ifdef ENABLE_MATCHER_STATS
+	assert(config->steps > 0u);
+	assert(config->steps == patterns[0]->steps + patterns[1]->steps);
+#else
+	assert(config->steps == 0u && config->max_depth == 0u);
+#endif
+	close_pam_stats_file(file);
+	unlink(file_name);
+}
+#endif
+
+/* Call pam_sm_authenticate with a new PAM handle.
+ * The number of the syslog messages and the messages are stored to
+ * syslog_count and log_text.
+ */
+static int
+authenticate_logged(
+	char const *const *const argv,
+	int const argc,
+	char const *const ssh_auth_info,
+	unsigned long *const syslog_count,
+	char *const log_text,
+	size_t const log_size
+	) {
+	FILE *const log = tmpfile();
+	assert(log);
+	pam_handle_t *const pamh = start(ssh_auth_info, log);
+	int const result = pam_sm_authenticate(
+		pamh,
+		0,
+		argc,
+		(char const **)argv
+		);
+	*syslog_count = pam_shim_syslog_count(pamh);
+	pam_shim_end(pamh, result);
+	read_log(log, log_text, log_size);
+	return result;
+}
+
+/* Check that the debug=timing option logs a summary per pattern instead of
+ * the line matches in the single result message.
+ */
+static void
+check_debug_timing(void) {
+	char const *const argv[] = {"debug=timing", "publickey", "password"};
+	unsigned long syslog_count;
+	char log_text[4096];
+	assert(authenticate_logged(
+		argv,
+		3,
+		ED25519_LINE,
+		&syslog_count,
+		log_text,
+		sizeof log_text
+		) == PAM_AUTH_ERR);
+	static char const expected[] =
+		"<6> ssh auth info pattern requirement \"password\" not met"
+		" by user user: pattern \"publickey\" matched 1 of 1 lines in ";
+	assert(syslog_count == 1u);
+	assert(strncmp(log_text, expected, sizeof expected - 1u) == 0);
+	assert(strstr(
+		log_text,
+		"; pattern \"password\" matched 0 of 1 lines in "
+		));
+	assert(!strstr(log_text, "line \""));
+}
+
+/* Check that the trace option logs the trace only if the authentication
+ * fails or the recursion limit is exhausted (and that it warns if
+ * the matcher is built without the trace).
+ */
+static void
+check_trace(void) {
+	static struct {
+		char const *argv[5];
+		int expected;
+		bool expected_trace;
+	} const data[] = {
+		{{"trace", "publickey", NULL}, PAM_SUCCESS, false},
+		{{"trace", "password", NULL}, PAM_AUTH_ERR, true},
+		/* The first pattern exhausts the recursion limit.
+		 */
+		{
+			{
+				"trace",
+				"recursion_limit=2",
+				"any_of",
+				"publickey=*=*(*(A|AA)B)",
+				"publickey"
+			},
+			PAM_SUCCESS,
+			true
+		},
+		{{NULL}, 0, false}
+	};
+	for (int i = 0; data[i].argv[0]; ++i) {
+		unsigned long syslog_count;
+		char log_text[8192];
+		int const argc = count_args(data[i].argv, 5);
+		assert(authenticate_logged(
+			data[i].argv,
+			argc,
+			ED25519_LINE,
+			&syslog_count,
+			log_text,
+			sizeof log_text
+			) == data[i].expected);
+		bool const trace = strstr(
+			log_text,
+			"<6> ssh auth info trace (last "
+			) != NULL;
+		bool const warning = strstr(
+			log_text,
+			"<4> trace option not supported"
+			) != NULL;
+#ifdef ENABLE_MATCHER_STATS
+		assert(trace == data[i].expected_trace && !warning);
+		assert(syslog_count == 1u + trace);
+#else
+		assert(!trace && warning);
+		assert(syslog_count == 2u);
+#endif
+	}
+}
+
+struct pam_ssh_auth_info_export_test_data {
+	char const *argv[4];
+	char const *ssh_auth_info;
+	int expected;
+	char const *expected_result;
+	char const *expected_pattern;
+	char const *expected_methods;
+	char const *expected_key_types;
+	char const *expected_key_fingerprints;
+};
+
+/* The exported variables must be overwritten on every path.
+ */
+static struct pam_ssh_auth_info_export_test_data const export_test_data[] = {
+	{
+		{"export", "any_of", "password", "publickey"},
+		ED25519_LINE,
+		PAM_SUCCESS,
+		"success",
+		"1",
+		"publickey",
+		"ssh-ed25519",
+		ED25519_FINGERPRINT
+	},
+	{
+		{"export", "password", NULL},
+		ED25519_LINE,
+		PAM_AUTH_ERR,
+		"failure",
+		"0",
+		"publickey",
+		"ssh-ed25519",
+		ED25519_FINGERPRINT
+	},
+	/* The keys are listed in the line order and the lines without keys
+	 * are skipped.
+	 */
+	{
+		{"export", "at_least=2", "publickey"},
+		ED25519_LINE "\npassword\n" RSA_LINE,
+		PAM_SUCCESS,
+		"success",
+		"",
+		"publickey,password,publickey",
+		"ssh-ed25519,ssh-rsa",
+		ED25519_FINGERPRINT "," RSA_FINGERPRINT
+	},
+	{
+		{"export", "publickey", NULL},
+		NULL,
+		PAM_IGNORE,
+		"ignored",
+		"",
+		"",
+		"",
+		""
+	},
+	{
+		{"export", "publickey", NULL},
+		"",
+		PAM_IGNORE,
+		"ignored",
+		"",
+		"",
+		"",
+		""
+	},
+	{
+		{"export", "disable=sshd", "publickey"},
+		ED25519_LINE,
+		PAM_IGNORE,
+		"ignored",
+		"",
+		"",
+		"",
+		""
+	},
+	{
+		{"export", "at_least=x", "publickey"},
+		ED25519_LINE,
+		PAM_SERVICE_ERR,
+		"error",
+		"",
+		"",
+		"",
+		""
+	},
+	{
+		{"export", "complexity_limit=1", "publickey=*=*"},
+		ED25519_LINE,
+		PAM_SERVICE_ERR,
+		"error",
+		"",
+		"",
+		"",
+		""
+	},
+	{
+		{"export", "re:(", NULL},
+		ED25519_LINE,
+		PAM_SERVICE_ERR,
+		"error",
+		"",
+		"",
+		"",
+		""
+	},
+	{{NULL}, NULL, 0, NULL, NULL, NULL, NULL, NULL}
+};
+
+int
+main() {
+	for (int i = 0; test_data[i].argv[0]; ++i) {
+		struct pam_ssh_auth_info_test_data const *const data =
+			&test_data[i];
+		int const argc = count_args(data->argv, 4);
+		int const actual = authenticate(
+			data->argv,
+			argc,
+			data->ssh_auth_info,
+			NULL
+			);
+		fprintf(
+			stderr,
+			"%s ... \"%s\": %d\n",
+			data->argv[0],
+			data->ssh_auth_info ? data->ssh_auth_info : "(null)",
+			actual
+			);
+		assert(actual == data->expected);
+	}
+	/* Sampling limits the debugging messages but the result is logged
+	 * for every invocation (together with the debugging messages if
+	 * sampled).
+	 */
+	char const *const sampled_argv[] = {
+		"log_sample=1000000",
+		"debug",
+		"publickey"
+	};
+	char const *const quiet_sampled_argv[] = {
+		"log_sample=1000000",
+		"quiet",
+		"publickey"
+	};
+	for (int i = 0; i < 10; ++i) {
+		unsigned long syslog_count;
+		assert(authenticate(
+			sampled_argv,
+			3,
+			ED25519_LINE,
+			&syslog_count
+			) == PAM_SUCCESS);
+		assert(syslog_count == 1u);
+		assert(authenticate(
+			quiet_sampled_argv,
+			3,
+			"password",
+			&syslog_count
+			) == PAM_AUTH_ERR);
+		assert(syslog_count == 0u);
+	}
+#ifdef PAM_STATS_SUPPORTED
+	check_stats();
+#endif
+	check_debug_timing();
+	check_trace();
+	for (int i = 0; reorder_test_data[i].argv[0]; ++i) {
+		struct pam_ssh_auth_info_reorder_test_data const *const data =
+			&reorder_test_data[i];
+		char patterns[2][16];
+		char log_texts[2][1024];
+		int results[2];
+		for (int j = 0; j < 2; ++j)
+			results[j] = authenticate_reorder(
+				data,
+				j,
+				patterns[j],
+				sizeof patterns[j],
+				log_texts[j],
+				sizeof log_texts[j]
+				);
+		fprintf(
+			stderr,
+			"%s ... %d \"%s\", reorder %d \"%s\"\n",
+			data->argv[0],
+			results[0],
+			patterns[0],
+			results[1],
+			patterns[1]
+			);
+		assert(results[0] == data->expected);
+		assert(strcmp(patterns[0], data->expected_pattern) == 0);
+		assert(results[1] == results[0]);
+		assert(strcmp(patterns[1], patterns[0]) == 0);
+		/* The logged result names the same decisive pattern.
+		 */
+		assert(strcmp(log_texts[1], log_texts[0]) == 0);
+		if (*data->expected_pattern) {
+			char quoted[64];
+			snprintf(
+				quoted,
+				sizeof quoted,
+				"pattern requirement \"%s\"",
+				data->argv[1 + atoi(data->expected_pattern)]
+				);
+			assert(strstr(log_texts[0], quoted));
+		}
+	}
+	for (int i = 0; export_test_data[i].argv[0]; ++i) {
+		struct pam_ssh_auth_info_export_test_data const *const data =
+			&export_test_data[i];
+		pam_handle_t *const pamh = start(data->ssh_auth_info, stderr);
+		static char const *const stale_variables[] = {
+			"PAM_SSH_AUTH_INFO_RESULT=success",
+			"PAM_SSH_AUTH_INFO_PATTERN=0",
+			"PAM_SSH_AUTH_INFO_METHODS=publickey",
+			"PAM_SSH_AUTH_INFO_KEY_TYPES=ssh-rsa",
+			"PAM_SSH_AUTH_INFO_KEY_FINGERPRINTS=SHA256:stale",
+			NULL
+		};
+		for (int j = 0; stale_variables[j]; ++j)
+			assert(pam_putenv(
+				pamh,
+				stale_variables[j]
+				) == PAM_SUCCESS);
+		int const actual = pam_sm_authenticate(
+			pamh,
+			0,
+			count_args(data->argv, 4),
+			(char const **)data->argv
+			);
+		fprintf(stderr, "%s ... %d\n", data->argv[1], actual);
+		assert(actual == data->expected);
+		assert_env(
+			pamh,
+			"PAM_SSH_AUTH_INFO_RESULT",
+			data->expected_result
+			);
+		assert_env(
+			pamh,
+			"PAM_SSH_AUTH_INFO_PATTERN",
+			data->expected_pattern
+			);
+		assert_env(
+			pamh,
+			"PAM_SSH_AUTH_INFO_METHODS",
+			data->expected_methods
+			);
+		assert_env(
+			pamh,
+			"PAM_SSH_AUTH_INFO_KEY_TYPES",
+			data->expected_key_types
+			);
+		assert_env(
+			pamh,
+			"PAM_SSH_AUTH_INFO_KEY_FINGERPRINTS",
+			data->expected_key_fingerprints
+			);
+		pam_shim_end(pamh, actual);
+	}
+	return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAM_STATS_H
+#define PAM_STATS_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* A stats file (see the stats option).
+ *
+ * A stats file is a fixed size, fixed layout file which is shared (using
+ * mmap) by all the module invocations and updated using atomic operations
+ * only so that concurrent invocations never wait for each other.
+ * A new (empty or zero filled) file is a valid empty stats file.
+ *
+ * The file contains a fixed size open addressing hash table of slots.
+ * A slot is claimed for a key by atomically changing the slot key from zero
+ * to the key. After that, the claimer fills in the rest of the slot
+ * identification and marks the slot as ready.
+ * The counters of the slot can be updated by anyone before that.
+ */
+
+#define PAM_STATS_MAGIC UINT64_C(0x50414d5354415431)  /* "PAMSTAT1" */
+#define PAM_STATS_SLOTS 1024u
+#define PAM_STATS_TEXT_SIZE 440u
+
+#if defined(__GNUC__) && defined(__ATOMIC_RELAXED)
+#	define PAM_STATS_SUPPORTED 1
+#endif
+
+enum pam_stats_slot_kind {
+	PAM_STATS_CONFIG = 1,
+	PAM_STATS_PATTERN = 2
+};
+
+struct pam_stats_counters {
+	/* The number of the invocations (configurations) or
+	 * the evaluated SSH authentication information lines (patterns).
+	 */
+	uint64_t evaluations;
+	/* The number of the successful invocations (configurations) or
+	 * the matching SSH authentication information lines (patterns).
+	 */
+	uint64_t matches;
+	/* The cumulative evaluation time in nanoseconds.
+	 */
+	uint64_t nanoseconds;
+	/* The cumulative number of the matching steps (partial match calls and
+	 * parsed pattern entities).
+	 */
+	uint64_t steps;
+	/* The maximum recursion depth.
+	 */
+	uint64_t max_depth;
+	/* The number of the recursion limit and match limit exhaustions.
+	 */
+	uint64_t exhaustions;
+};
+
+struct pam_stats_slot {
+	/* The key or zero if the slot is free.
+	 */
+	uint64_t key;
+	/* The key of the configuration of a pattern slot.
+	 */
+	uint64_t parent;
+	/* The kind (see enum pam_stats_slot_kind) or zero if the slot is not
+	 * ready.
+	 */
+	uint32_t kind;
+	/* The pattern index of a pattern slot.
+	 */
+	uint32_t index;
+	struct pam_stats_counters counters;
+	/* The (possibly truncated) configuration or pattern.
+	 */
+	char text[PAM_STATS_TEXT_SIZE];
+};
+
+struct pam_stats_file {
+	uint64_t magic;
+	uint64_t reserved;
+	struct pam_stats_slot slots[PAM_STATS_SLOTS];
+};
+
+/* Open and map a stats file.
+ * A missing or empty file is created if writable is true.
+ * Returns the mapped file which must be closed with close_pam_stats_file or
+ * NULL (and sets errno) on error.
+ */
+static struct pam_stats_file *
+open_pam_stats_file(char const *const file_name, bool const writable) {
+#ifdef PAM_STATS_SUPPORTED
+	int const fd = open(
+		file_name,
+		(writable ? O_RDWR | O_CREAT : O_RDONLY) |
+		O_CLOEXEC |
+		O_NOFOLLOW,
+		0644
+		);
+	if (fd < 0)
+		return NULL;
+	struct stat st;
+	int error = 0;
+	if (fstat(fd, &st) < 0)
+		error = errno;
+	else if (!S_ISREG(st.st_mode))
+		error = EINVAL;
+	else if (st.st_size == 0 && writable) {
+		if (ftruncate(fd, (off_t)sizeof (struct pam_stats_file)) < 0)
+			error = errno;
+	}
+	else if (st.st_size != (off_t)sizeof (struct pam_stats_file))
+		error = EINVAL;
+	void *p = MAP_FAILED;
+	if (!error) {
+		p = mmap(
+			NULL,
+			sizeof (struct pam_stats_file),
+			writable ? PROT_READ | PROT_WRITE : PROT_READ,
+			MAP_SHARED,
+			fd,
+			0
+			);
+		if (p == MAP_FAILED)
+			error = errno;
+	}
+	close(fd);
+	if (error) {
+		errno = error;
+		return NULL;
+	}
+	struct pam_stats_file *const file = p;
+	uint64_t magic = 0u;
+	if (writable)
+		__atomic_compare_exchange_n(
+			&file->magic,
+			&magic,
+			PAM_STATS_MAGIC,
+			false,
+			__ATOMIC_ACQ_REL,
+			__ATOMIC_ACQUIRE
+			);
+	else
+		magic = __atomic_load_n(&file->magic, __ATOMIC_ACQUIRE);
+	if (magic != 0u && magic != PAM_STATS_MAGIC) {
+		munmap(p, sizeof (struct pam_stats_file));
+		errno = EINVAL;
+		return NULL;
+	}
+	return file;
+#else
+	(void)file_name;
+	(void)writable;
+	errno = ENOTSUP;
+	return NULL;
+#endif
+}
+
+static void
+close_pam_stats_file(struct pam_stats_file *const file) {
+	munmap(file, sizeof *file);
+}
+
+#endif  /* PAM_STATS_H */
@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#undef NDEBUG
+
+#if !defined(_POSIX_C_SOURCE)
+#	define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/wait.h>
+
+#include "pam_stats_update.h"
+
+#define N_CHILDREN 4
+#define N_UPDATES 1000u
+
+static struct pam_stats_slot *
+find_slot(struct pam_stats_file *const file, uint64_t const key) {
+	return find_pam_stats_slot(
+		file,
+		key,
+		PAM_STATS_CONFIG,
+		0u,
+		0u,
+		"config",
+		6u
+		);
+}
+
+int
+main() {
+	char file_name[] = "pam_stats_test.XXXXXX";
+	int const fd = mkstemp(file_name);
+	assert(fd >= 0);
+	close(fd);
+	/* A new empty file is a valid empty stats file.
+	 */
+	struct pam_stats_file *const file = open_pam_stats_file(
+		file_name,
+		true
+		);
+	assert(file);
+	assert(file->magic == PAM_STATS_MAGIC);
+	uint64_t const key = hash_pam_stats_key(0u, "sshd", 5u);
+	assert(key == hash_pam_stats_key(0u, "sshd", 5u));
+	assert(key != hash_pam_stats_key(0u, "sudo", 5u));
+	struct pam_stats_slot *const slot = find_slot(file, key);
+	assert(slot);
+	assert(slot->key == key);
+	assert(slot->kind == PAM_STATS_CONFIG);
+	assert(strcmp(slot->text, "config") == 0);
+	assert(find_slot(file, key) == slot);
+	/* Colliding keys are placed to different slots.
+	 */
+	struct pam_stats_slot *const other =
+		find_slot(file, key + PAM_STATS_SLOTS);
+	assert(other && other != slot);
+	assert(find_slot(file, key + PAM_STATS_SLOTS) == other);
+	/* Long texts are truncated.
+	 */
+	char text[2u * PAM_STATS_TEXT_SIZE];
+	memset(text, 'x', sizeof text);
+	struct pam_stats_slot *const pattern = find_pam_stats_slot(
+		file,
+		key + 1u,
+		PAM_STATS_PATTERN,
+		key,
+		3u,
+		text,
+		sizeof text
+		);
+	assert(pattern && pattern != slot && pattern != other);
+	assert(pattern->parent == key);
+	assert(pattern->index == 3u);
+	assert(pattern->kind == PAM_STATS_PATTERN);
+	assert(strlen(pattern->text) == PAM_STATS_TEXT_SIZE - 1u);
+	/* The counters are added but the maximum depth is maximized.
+	 */
+	struct pam_stats_counters const a = {1u, 1u, 100u, 10u, 2u, 0u};
+	struct pam_stats_counters const b = {2u, 0u, 50u, 20u, 1u, 1u};
+	add_pam_stats_counters(pattern, &a);
+	add_pam_stats_counters(pattern, &b);
+	assert(pattern->counters.evaluations == 3u);
+	assert(pattern->counters.matches == 1u);
+	assert(pattern->counters.nanoseconds == 150u);
+	assert(pattern->counters.steps == 30u);
+	assert(pattern->counters.max_depth == 2u);
+	assert(pattern->counters.exhaustions == 1u);
+	/* Concurrent processes neither lose updates nor claim the same key
+	 * twice.
+	 */
+	for (int i = 0; i < N_CHILDREN; ++i) {
+		pid_t const pid = fork();
+		assert(pid >= 0);
+		if (pid)
+			continue;
+		struct pam_stats_file *const child_file =
+			open_pam_stats_file(file_name, true);
+		if (!child_file)
+			_exit(1);
+		for (unsigned n = 0u; n < N_UPDATES; ++n) {
+			struct pam_stats_counters const c = {
+				1u, 0u, 0u, 1u, (uint64_t)i, 0u
+			};
+			struct pam_stats_slot *const p =
+				find_slot(child_file, key + 2u + n % 8u);
+			if (!p)
+				_exit(1);
+			add_pam_stats_counters(p, &c);
+		}
+		close_pam_stats_file(child_file);
+		_exit(0);
+	}
+	for (int i = 0; i < N_CHILDREN; ++i) {
+		int status;
+		assert(wait(&status) > 0);
+		assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	}
+	uint64_t evaluations = 0u;
+	size_t n_slots = 0u;
+	for (size_t i = 0u; i < PAM_STATS_SLOTS; ++i) {
+		struct pam_stats_slot const *const p = &file->slots[i];
+		if (p->key < key + 2u || p->key >= key + 10u)
+			continue;
+		assert(p->counters.evaluations == p->counters.steps);
+		assert(p->counters.max_depth == N_CHILDREN - 1u);
+		evaluations += p->counters.evaluations;
+		++n_slots;
+	}
+	fprintf(
+		stderr,
+		"%zu slots, %lu evaluations\n",
+		n_slots,
+		(unsigned long)evaluations
+		);
+	assert(n_slots == 8u);
+	assert(evaluations == N_CHILDREN * N_UPDATES);
+	close_pam_stats_file(file);
+	/* A file of a wrong size is not a stats file.
+	 */
+	assert(truncate(file_name, 1) == 0);
+	assert(!open_pam_stats_file(file_name, true));
+	assert(errno == EINVAL);
+	unlink(file_name);
+	return 0;
+}
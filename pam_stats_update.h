@@ -0,0 +1,143 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAM_STATS_UPDATE_H
+#define PAM_STATS_UPDATE_H
+
+#include <string.h>
+
+#include "pam_stats.h"
+
+/* Hash character bytes (FNV-1a).
+ * Start with a zero hash.
+ */
+static uint64_t
+hash_pam_stats_key(uint64_t hash, void const *const data, size_t const len) {
+	unsigned char const *const p = data;
+	if (!hash)
+		hash = UINT64_C(0xcbf29ce484222325);
+	for (size_t i = 0u; i < len; ++i) {
+		hash ^= p[i];
+		hash *= UINT64_C(0x100000001b3);
+	}
+	return hash ? hash : 1u;
+}
+
+/* Find or claim the slot of a key.
+ * Returns the slot or NULL if the file is full.
+ */
+static struct pam_stats_slot *
+find_pam_stats_slot(
+	struct pam_stats_file *const file,
+	uint64_t const key,
+	enum pam_stats_slot_kind const kind,
+	uint64_t const parent,
+	uint32_t const index,
+	char const *const text,
+	size_t const text_len
+	) {
+#ifdef PAM_STATS_SUPPORTED
+	for (uint32_t n = 0u; n < PAM_STATS_SLOTS; ++n) {
+		struct pam_stats_slot *const slot =
+			&file->slots[(key + n) % PAM_STATS_SLOTS];
+		uint64_t slot_key = __atomic_load_n(
+			&slot->key,
+			__ATOMIC_ACQUIRE
+			);
+		if (slot_key == key)
+			return slot;
+		if (slot_key != 0u)
+			continue;
+		if (!__atomic_compare_exchange_n(
+			&slot->key,
+			&slot_key,
+			key,
+			false,
+			__ATOMIC_ACQ_REL,
+			__ATOMIC_ACQUIRE
+			)) {
+			if (slot_key == key)
+				return slot;
+			continue;
+		}
+		size_t const len = text_len < PAM_STATS_TEXT_SIZE
+			? text_len
+			: PAM_STATS_TEXT_SIZE - 1u;
+		slot->parent = parent;
+		slot->index = index;
+		memcpy(slot->text, text, len);
+		slot->text[len] = '\0';
+		__atomic_store_n(&slot->kind, (uint32_t)kind, __ATOMIC_RELEASE);
+		return slot;
+	}
+#else
+	(void)file;
+	(void)key;
+	(void)kind;
+	(void)parent;
+	(void)index;
+	(void)text;
+	(void)text_len;
+#endif
+	return NULL;
+}
+
+/* Add counters to the counters of a slot.
+ * The maximum recursion depth is updated to the maximum of the two.
+ */
+static void
+add_pam_stats_counters(
+	struct pam_stats_slot *const slot,
+	struct pam_stats_counters const *const counters
+	) {
+#ifdef PAM_STATS_SUPPORTED
+	struct pam_stats_counters *const p = &slot->counters;
+	__atomic_fetch_add(
+		&p->evaluations,
+		counters->evaluations,
+		__ATOMIC_RELAXED
+		);
+	__atomic_fetch_add(&p->matches, counters->matches, __ATOMIC_RELAXED);
+	__atomic_fetch_add(
+		&p->nanoseconds,
+		counters->nanoseconds,
+		__ATOMIC_RELAXED
+		);
+	__atomic_fetch_add(&p->steps, counters->steps, __ATOMIC_RELAXED);
+	__atomic_fetch_add(
+		&p->exhaustions,
+		counters->exhaustions,
+		__ATOMIC_RELAXED
+		);
+	uint64_t max_depth = __atomic_load_n(&p->max_depth, __ATOMIC_RELAXED);
+	while (max_depth < counters->max_depth && !__atomic_compare_exchange_n(
+		&p->max_depth,
+		&max_depth,
+		counters->max_depth,
+		true,
+		__ATOMIC_RELAXED,
+		__ATOMIC_RELAXED
+		))
+		;
+#else
+	(void)slot;
+	(void)counters;
+#endif
+}
+
+#endif  /* PAM_STATS_UPDATE_H */
@@ -16,6 +16,9 @@
  * <http://www.gnu.org/licenses/>.
  */
 
+#ifndef PATTERN_H
+#define PATTERN_H
+
 #include <assert.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -96,7 +99,17 @@ in_character_byte_set(
 	struct character_byte_set const *const set,
 	char const ch
 	) {
-	return memchr(set->ptr, ch, set->len) != NULL;
+	/* The sets are usually empty (within extended patterns) or
+	 * contain a single character byte (such as "=" and " ").
+	 */
+	switch (set->len) {
+	case 0u:
+		return false;
+	case 1u:
+		return *set->ptr == ch;
+	default:
+		return memchr(set->ptr, ch, set->len) != NULL;
+	}
 }
 
 struct extended_pattern_info {
@@ -191,6 +204,7 @@ parse_extended_pattern(
 
 struct wildcard_pattern_info {
 	char const *next_character_byte;
+	char const *next_character_byte_class;
 };
 
 enum pattern_type {
@@ -227,6 +241,7 @@ parse_next_pattern_entity(
 		if (wildcard_pattern) {
 			++*pattern_ptr;
 			wildcard_pattern->next_character_byte = NULL;
+			wildcard_pattern->next_character_byte_class = NULL;
 			return WILDCARD_PATTERN_MATCH_ONE;
 		}
 		break;
@@ -241,6 +256,7 @@ parse_next_pattern_entity(
 		if (wildcard_pattern) {
 			++*pattern_ptr;
 			wildcard_pattern->next_character_byte = NULL;
+			wildcard_pattern->next_character_byte_class = NULL;
 			return WILDCARD_PATTERN_MATCH_ANY;
 		}
 		break;
@@ -377,3 +393,5 @@ measure_pattern(
 			++len->max;
 	}
 }
+
+#endif  /* PATTERN_H */
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_ANALYSIS_H
+#define PATTERN_ANALYSIS_H
+
+#include <limits.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "pattern_bitset.h"
+
+/* A character byte set of a pattern entity.
+ */
+struct pattern_entity_bitset {
+	/* The position of the pattern entity (see struct pattern_analysis).
+	 */
+	char const *pattern;
+	struct character_byte_bitset set;
+	/* The set as nibble tables (see find_character_byte_in_bitset).
+	 * The low nibble of a character byte selects a column from
+	 * the first table (for the high nibbles 0-7) or from the second
+	 * table (for the high nibbles 8-15) and the rest of the high nibble
+	 * selects a bit from that column.
+	 */
+	unsigned char columns[2][16];
+};
+
+/* Character byte sets sorted by the positions of their pattern entities.
+ */
+struct pattern_entity_bitsets {
+	size_t len;
+	struct pattern_entity_bitset const *ptr;
+};
+
+/* The results of analyzing patterns before matching (see analyze_patterns).
+ */
+struct pattern_analysis {
+	/* The possessive repetition extended patterns (see
+	 * find_possessive_character_byte_set) by the beginnings of
+	 * the extended pattern contents.
+	 */
+	struct pattern_entity_bitsets possessive;
+	/* The character byte classes by their beginnings.
+	 */
+	struct pattern_entity_bitsets classes;
+	/* The character bytes which are not plain (see
+	 * measure_plain_character_bytes) in the patterns and in the patterns
+	 * within extended patterns which are matched without separators.
+	 */
+	struct character_byte_bitset non_plain;
+	struct character_byte_bitset extended_non_plain;
+};
+
+static bool
+character_byte_bitset_contains(
+	struct character_byte_bitset const *const set,
+	char const ch
+	) {
+	unsigned char const uch = (unsigned char)ch;
+	return (set->bits[uch / CHAR_BIT] >> (uch % CHAR_BIT)) & 1u;
+}
+
+/* Prepare the nibble tables of a pattern entity bitset.
+ */
+static void
+prepare_pattern_entity_bitset_columns(
+	struct pattern_entity_bitset *const bitset
+	) {
+	memset(bitset->columns, 0, sizeof bitset->columns);
+	for (unsigned ch = 0u; ch <= UCHAR_MAX; ++ch) {
+		if (character_byte_bitset_contains(&bitset->set, (char)ch))
+			bitset->columns[ch >> 7][ch & 0xfu] |=
+				(unsigned char)(1u << ((ch >> 4) & 7u));
+	}
+}
+
+static struct pattern_entity_bitset const *
+find_pattern_entity_bitset(
+	struct pattern_entity_bitsets const *const bitsets,
+	char const *const pattern
+	) {
+	size_t lo = 0u;
+	size_t hi = bitsets->len;
+	while (lo < hi) {
+		size_t const mid = lo + (hi - lo) / 2u;
+		if (bitsets->ptr[mid].pattern == pattern)
+			return &bitsets->ptr[mid];
+		if (bitsets->ptr[mid].pattern < pattern)
+			lo = mid + 1u;
+		else
+			hi = mid;
+	}
+	return NULL;
+}
+
+#endif  /* PATTERN_ANALYSIS_H */
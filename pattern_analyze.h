@@ -0,0 +1,353 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_ANALYZE_H
+#define PATTERN_ANALYZE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pattern.h"
+#include "pattern_analysis.h"
+#include "pattern_bitset.h"
+
+/* Check if a repetition extended pattern is possessive, that is if
+ *  1) every pattern in the extended pattern matches exactly one character
+ *     byte and
+ *  2) the pattern entity following the extended pattern cannot match any of
+ *     those character bytes.
+ * Then, the only split point which can lead to a match is at the end of
+ * the longest run of those character bytes (within the token) and
+ * the extended pattern can be matched greedily without backtracking.
+ * If so, also collect the character bytes into a set.
+ */
+static bool
+find_possessive_character_byte_set(
+	struct character_byte_set const *const pattern_separators,
+	struct character_byte_set const *const token_separators,
+	struct extended_pattern_info const *const info,
+	char const *next_pattern,
+	char const *const pattern_end,
+	struct character_byte_bitset *const set
+	) {
+	char character_byte;
+	struct character_byte_class_info character_byte_class;
+	struct extended_pattern_info extended_pattern;
+	struct wildcard_pattern_info wildcard_pattern;
+	bool const measure_extended_patterns_off = false;
+	struct character_byte_bitset next_set;
+	if (info->count.max == 0u)  /* !(...) */
+		return false;
+	if (info->count.min == info->count.max)  /* @(...) */
+		return false;
+	if (info->match_len.min != 1u || info->match_len.max != 1u)
+		return false;
+	if (next_pattern >= pattern_end)
+		return false;
+	memset(set, 0, sizeof *set);
+	for (char const *pattern = info->begin;;) {
+		char const *const pattern2_end = find_in_pattern(
+			pattern,
+			info->end,
+			'|',
+			info->end
+			);
+		switch (parse_next_pattern_entity(
+			&pattern,
+			pattern2_end,
+			NULL,
+			NULL,
+			&character_byte,
+			&character_byte_class,
+			&extended_pattern,
+			&wildcard_pattern,
+			measure_extended_patterns_off
+			)) {
+		case CHARACTER_BYTE_PATTERN:
+			character_byte_bitset_add(set, character_byte);
+			break;
+		case CHARACTER_BYTE_CLASS_PATTERN:
+			character_byte_bitset_add_class(
+				set,
+				&character_byte_class
+				);
+			break;
+		case WILDCARD_PATTERN_MATCH_ONE:
+			character_byte_bitset_add_all(set);
+			break;
+		default:
+			return false;
+		}
+		if (pattern != pattern2_end)
+			return false;
+		if (pattern2_end == info->end)
+			break;
+		pattern = pattern2_end + 1;
+	}
+	memset(&next_set, 0, sizeof next_set);
+	switch (parse_next_pattern_entity(
+		&next_pattern,
+		pattern_end,
+		pattern_separators,
+		token_separators,
+		&character_byte,
+		&character_byte_class,
+		&extended_pattern,
+		&wildcard_pattern,
+		measure_extended_patterns_off
+		)) {
+	case TOKEN_SEPARATOR_PATTERN:
+		/* The extended pattern cannot match a token separator.
+		 */
+		return true;
+	case PATTERN_SEPARATOR_PATTERN:
+		/* The pattern separator can match either itself or a token
+		 * separator.
+		 */
+		/* FALLTHROUGH */
+	case CHARACTER_BYTE_PATTERN:
+		character_byte_bitset_add(&next_set, character_byte);
+		break;
+	case CHARACTER_BYTE_CLASS_PATTERN:
+		character_byte_bitset_add_class(
+			&next_set,
+			&character_byte_class
+			);
+		break;
+	default:
+		return false;
+	}
+	return !character_byte_bitsets_intersect(set, &next_set);
+}
+
+/* The pattern entity bitsets being analyzed.
+ * The bitsets are only counted while the pointers are NULL.
+ */
+struct pattern_analysis_entries {
+	struct pattern_entity_bitset *possessive;
+	struct pattern_entity_bitset *classes;
+	size_t possessive_len;
+	size_t classes_len;
+};
+
+static void
+add_pattern_entity_bitset(
+	struct pattern_entity_bitset *const bitsets,
+	size_t *const len,
+	char const *const pattern,
+	struct character_byte_bitset const *const set
+	) {
+	if (bitsets) {
+		bitsets[*len].pattern = pattern;
+		bitsets[*len].set = *set;
+		prepare_pattern_entity_bitset_columns(&bitsets[*len]);
+	}
+	++*len;
+}
+
+/* Analyze the pattern entities in a pattern.
+ * The patterns within extended patterns are analyzed without separators like
+ * they are matched.
+ */
+static void
+analyze_pattern_entities(
+	char const *pattern,
+	char const *const pattern_end,
+	struct character_byte_set const *const pattern_separators,
+	struct character_byte_set const *const token_separators,
+	struct pattern_analysis_entries *const entries
+	) {
+	while (pattern < pattern_end) {
+		char const *const entity = pattern;
+		char character_byte;
+		struct character_byte_class_info character_byte_class;
+		struct extended_pattern_info extended_pattern;
+		struct wildcard_pattern_info wildcard_pattern;
+		bool const measure_extended_patterns_on = true;
+		struct character_byte_bitset set;
+		switch (parse_next_pattern_entity(
+			&pattern,
+			pattern_end,
+			pattern_separators,
+			token_separators,
+			&character_byte,
+			&character_byte_class,
+			&extended_pattern,
+			&wildcard_pattern,
+			measure_extended_patterns_on
+			)) {
+		case CHARACTER_BYTE_CLASS_PATTERN:
+			memset(&set, 0, sizeof set);
+			character_byte_bitset_add_class(
+				&set,
+				&character_byte_class
+				);
+			add_pattern_entity_bitset(
+				entries->classes,
+				&entries->classes_len,
+				entity,
+				&set
+				);
+			continue;
+		case EXTENDED_PATTERN:
+			break;
+		default:
+			continue;
+		}
+		if (find_possessive_character_byte_set(
+			pattern_separators,
+			token_separators,
+			&extended_pattern,
+			pattern,
+			pattern_end,
+			&set
+			))
+			add_pattern_entity_bitset(
+				entries->possessive,
+				&entries->possessive_len,
+				extended_pattern.begin,
+				&set
+				);
+		/* Analyze the patterns in the extended pattern.
+		 */
+		for (char const *pattern2 = extended_pattern.begin;;) {
+			char const *const pattern2_end = find_in_pattern(
+				pattern2,
+				extended_pattern.end,
+				'|',
+				extended_pattern.end
+				);
+			analyze_pattern_entities(
+				pattern2,
+				pattern2_end,
+				NULL,
+				NULL,
+				entries
+				);
+			if (pattern2_end == extended_pattern.end)
+				break;
+			pattern2 = pattern2_end + 1;
+		}
+	}
+}
+
+/* Add the special pattern character bytes and the separator character
+ * bytes to a set.
+ */
+static void
+add_non_plain_character_bytes(
+	struct character_byte_bitset *const set,
+	struct character_byte_set const *const pattern_separators,
+	struct character_byte_set const *const token_separators
+	) {
+	for (char const *p = "!*+?@[\\"; *p; ++p)
+		character_byte_bitset_add(set, *p);
+	for (size_t i = 0u; i < pattern_separators->len; ++i)
+		character_byte_bitset_add(set, pattern_separators->ptr[i]);
+	for (size_t i = 0u; i < token_separators->len; ++i)
+		character_byte_bitset_add(set, token_separators->ptr[i]);
+}
+
+static int
+compare_pattern_entity_bitsets(void const *const a, void const *const b) {
+	char const *const pattern_a =
+		((struct pattern_entity_bitset const *)a)->pattern;
+	char const *const pattern_b =
+		((struct pattern_entity_bitset const *)b)->pattern;
+	return pattern_a < pattern_b ? -1 : pattern_a > pattern_b;
+}
+
+/* Analyze the patterns once before matching them (see struct
+ * pattern_analysis) so that the matcher only needs to look up the results.
+ * The patterns must be matched with the same separators.
+ * Returns the analysis which must be freed with free or NULL if out of
+ * memory.
+ */
+static struct pattern_analysis *
+analyze_patterns(
+	int const n,
+	char const *const *const patterns,
+	struct character_byte_set const *const pattern_separators,
+	struct character_byte_set const *const token_separators
+	) {
+	struct pattern_analysis_entries entries = {NULL, NULL, 0u, 0u};
+	for (int i = 0; i < n; ++i)
+		analyze_pattern_entities(
+			patterns[i],
+			patterns[i] + strlen(patterns[i]),
+			pattern_separators,
+			token_separators,
+			&entries
+			);
+	struct pattern_analysis *const result = malloc(
+		sizeof *result + (
+			entries.possessive_len + entries.classes_len
+			) * sizeof (struct pattern_entity_bitset)
+		);
+	if (!result)
+		return NULL;
+	entries.possessive = (struct pattern_entity_bitset *)(result + 1);
+	entries.classes = entries.possessive + entries.possessive_len;
+	entries.possessive_len = 0u;
+	entries.classes_len = 0u;
+	for (int i = 0; i < n; ++i)
+		analyze_pattern_entities(
+			patterns[i],
+			patterns[i] + strlen(patterns[i]),
+			pattern_separators,
+			token_separators,
+			&entries
+			);
+	qsort(
+		entries.possessive,
+		entries.possessive_len,
+		sizeof *entries.possessive,
+		compare_pattern_entity_bitsets
+		);
+	qsort(
+		entries.classes,
+		entries.classes_len,
+		sizeof *entries.classes,
+		compare_pattern_entity_bitsets
+		);
+	result->possessive.len = entries.possessive_len;
+	result->possessive.ptr = entries.possessive;
+	result->classes.len = entries.classes_len;
+	result->classes.ptr = entries.classes;
+	struct character_byte_set const no_separators = {0, ""};
+	memset(&result->non_plain, 0, sizeof result->non_plain);
+	add_non_plain_character_bytes(
+		&result->non_plain,
+		pattern_separators,
+		token_separators
+		);
+	memset(
+		&result->extended_non_plain,
+		0,
+		sizeof result->extended_non_plain
+		);
+	add_non_plain_character_bytes(
+		&result->extended_non_plain,
+		&no_separators,
+		&no_separators
+		);
+	return result;
+}
+
+#endif  /* PATTERN_ANALYZE_H */
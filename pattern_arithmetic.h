@@ -0,0 +1,37 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_ARITHMETIC_H
+#define PATTERN_ARITHMETIC_H
+
+#include <stdint.h>
+
+/* Saturating size arithmetic for pattern cost and complexity bounds.
+ */
+
+static size_t
+add_saturating(size_t const a, size_t const b) {
+	return a <= SIZE_MAX - b ? a + b : SIZE_MAX;
+}
+
+static size_t
+multiply_saturating(size_t const a, size_t const b) {
+	return b == 0u || a <= SIZE_MAX / b ? a * b : SIZE_MAX;
+}
+
+#endif  /* PATTERN_ARITHMETIC_H */
@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_BITSET_H
+#define PATTERN_BITSET_H
+
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pattern.h"
+
+/* A set of character bytes.
+ */
+struct character_byte_bitset {
+	unsigned char bits[(UCHAR_MAX + 1) / CHAR_BIT];
+};
+
+static void
+character_byte_bitset_add(
+	struct character_byte_bitset *const set,
+	char const ch
+	) {
+	unsigned char const uch = (unsigned char)ch;
+	set->bits[uch / CHAR_BIT] |= (unsigned char)(1u << (uch % CHAR_BIT));
+}
+
+static void
+character_byte_bitset_add_all(struct character_byte_bitset *const set) {
+	memset(set->bits, UCHAR_MAX, sizeof set->bits);
+}
+
+static void
+character_byte_bitset_add_class(
+	struct character_byte_bitset *const set,
+	struct character_byte_class_info const *const info
+	) {
+	struct character_byte_bitset class_set;
+	memset(&class_set, 0, sizeof class_set);
+	for (char const *p = info->begin; p < info->end;) {
+		if (p[1] == '-' && p[2] != ']') {
+			/* A character byte range.
+			 */
+			for (int ch = p[0]; ch <= p[2]; ++ch)
+				character_byte_bitset_add(&class_set, (char)ch);
+			p += 3;
+		}
+		else {
+			/* A character byte.
+			 */
+			character_byte_bitset_add(&class_set, *p);
+			++p;
+		}
+	}
+	for (size_t i = 0u; i < sizeof set->bits; ++i) {
+		set->bits[i] |= (unsigned char)(
+			info->negation ? ~class_set.bits[i] : class_set.bits[i]
+			);
+	}
+}
+
+static bool
+character_byte_bitsets_intersect(
+	struct character_byte_bitset const *const set1,
+	struct character_byte_bitset const *const set2
+	) {
+	for (size_t i = 0u; i < sizeof set1->bits; ++i) {
+		if (set1->bits[i] & set2->bits[i])
+			return true;
+	}
+	return false;
+}
+
+#endif  /* PATTERN_BITSET_H */
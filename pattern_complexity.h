@@ -0,0 +1,309 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_COMPLEXITY_H
+#define PATTERN_COMPLEXITY_H
+
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pattern.h"
+#include "pattern_arithmetic.h"
+#include "pattern_bitset.h"
+
+static void
+character_byte_bitset_add_bitset(
+	struct character_byte_bitset *const set,
+	struct character_byte_bitset const *const set2
+	) {
+	for (size_t i = 0u; i < sizeof set->bits; ++i)
+		set->bits[i] |= set2->bits[i];
+}
+
+/* A worst-case step bound
+ *     factor * (n + 1) ^ (degree + unbounded * recursion_limit)
+ * where n is the length of the tokens.
+ * Each unbounded term corresponds to an ambiguous repetition which can only be
+ * bounded by the recursion limit.
+ */
+struct pattern_complexity_bound {
+	size_t factor;
+	unsigned degree;
+	unsigned unbounded;
+};
+
+struct pattern_complexity_info {
+	/* The worst-case step bound.
+	 */
+	struct pattern_complexity_bound steps;
+	/* The character bytes which can begin a match.
+	 */
+	struct character_byte_bitset first;
+	/* Whether an empty match is possible.
+	 */
+	bool nullable;
+	/* The maximum extended pattern nesting depth.
+	 */
+	unsigned depth;
+};
+
+static void
+add_pattern_complexity_bound(
+	struct pattern_complexity_bound *const bound,
+	struct pattern_complexity_bound const *const bound2
+	) {
+	bound->factor = add_saturating(bound->factor, bound2->factor);
+	if (bound->degree < bound2->degree)
+		bound->degree = bound2->degree;
+	if (bound->unbounded < bound2->unbounded)
+		bound->unbounded = bound2->unbounded;
+}
+
+static void
+multiply_pattern_complexity_bound(
+	struct pattern_complexity_bound *const bound,
+	struct pattern_complexity_bound const *const bound2
+	) {
+	bound->factor = multiply_saturating(bound->factor, bound2->factor);
+	bound->degree += bound2->degree;
+	bound->unbounded += bound2->unbounded;
+}
+
+/* Evaluate a worst-case step bound for a tokens length and
+ * a recursion limit.
+ */
+static size_t
+evaluate_pattern_complexity_bound(
+	struct pattern_complexity_bound const *const bound,
+	size_t const tokens_len,
+	unsigned const recursion_limit
+	) {
+	size_t steps = bound->factor;
+	size_t const base = add_saturating(tokens_len, 1u);
+	for (unsigned i = 0u; i < bound->degree && steps < SIZE_MAX; ++i)
+		steps = multiply_saturating(steps, base);
+	for (unsigned i = 0u; i < bound->unbounded; ++i) {
+		for (unsigned j = 0u; j < recursion_limit; ++j) {
+			if (steps == SIZE_MAX)
+				return steps;
+			steps = multiply_saturating(steps, base);
+		}
+	}
+	return steps;
+}
+
+/* Analyze the worst-case complexity of matching a pattern.
+ *
+ * The matcher tries multiple split points for every variable length entity
+ * (a wildcard pattern or a variable length extended pattern).
+ * Therefore, the cost of every entity is multiplied by the number of
+ * the split points of the preceding variable length entities.
+ * However, the matcher commits to the first match of the fixed length
+ * entities between two wildcard patterns.
+ * Token separators bound the backtracking but pattern separators do not
+ * (a pattern separator can match a character byte within a token).
+ * Repetitions (*(...) and +(...)) with fixed length, non-overlapping
+ * alternatives are linear but other repetitions are ambiguous and can only
+ * be bounded by the recursion limit.
+ */
+static void
+analyze_pattern_complexity(
+	char const *pattern,
+	char const *const pattern_end,
+	struct character_byte_set const *const pattern_separators,
+	struct character_byte_set const *const token_separators,
+	struct pattern_complexity_info *const info
+	) {
+	assert(pattern <= pattern_end);
+	static struct pattern_complexity_bound const one = {1u, 0u, 0u};
+	static struct pattern_complexity_bound const linear = {1u, 1u, 0u};
+	static struct pattern_complexity_bound const exponential = {1u, 0u, 1u};
+	/* The number of the split points of the preceding variable length
+	 * entities.
+	 */
+	struct pattern_complexity_bound split_points = one;
+	/* The number of the split points before the previous wildcard
+	 * pattern if there have been only fixed length entities after it.
+	 */
+	struct pattern_complexity_bound split_points_before_wildcard = one;
+	bool committing_wildcard = false;
+	bool previous_wildcard = false;
+	bool first_open = true;
+	memset(info, 0, sizeof *info);
+	info->nullable = true;
+	while (pattern < pattern_end) {
+		char character_byte;
+		struct character_byte_class_info character_byte_class;
+		struct extended_pattern_info extended_pattern;
+		struct wildcard_pattern_info wildcard_pattern;
+		bool const measure_extended_patterns_on = true;
+		struct pattern_complexity_bound cost = one;
+		struct pattern_complexity_bound const *multiplier = &one;
+		struct character_byte_bitset first;
+		bool nullable = false;
+		bool wildcard = false;
+		memset(&first, 0, sizeof first);
+		switch (parse_next_pattern_entity(
+			&pattern,
+			pattern_end,
+			pattern_separators,
+			token_separators,
+			&character_byte,
+			&character_byte_class,
+			&extended_pattern,
+			&wildcard_pattern,
+			measure_extended_patterns_on
+			)) {
+		case EXTENDED_PATTERN: {
+			/* The alternatives are matched against token heads.
+			 */
+			bool overlapping = false;
+			bool const fixed_len =
+				extended_pattern.match_len.min ==
+				extended_pattern.match_len.max;
+			cost.factor = 0u;
+			for (char const *pattern2 = extended_pattern.begin;;) {
+				struct pattern_complexity_info info2;
+				char const *const pattern2_end =
+					find_in_pattern(
+						pattern2,
+						extended_pattern.end,
+						'|',
+						extended_pattern.end
+						);
+				analyze_pattern_complexity(
+					pattern2,
+					pattern2_end,
+					NULL,
+					NULL,
+					&info2
+					);
+				add_pattern_complexity_bound(
+					&cost,
+					&info2.steps
+					);
+				if (
+					info2.nullable ||
+					character_byte_bitsets_intersect(
+						&first,
+						&info2.first
+						)
+					)
+					overlapping = true;
+				character_byte_bitset_add_bitset(
+					&first,
+					&info2.first
+					);
+				if (info2.nullable)
+					nullable = true;
+				if (info->depth < info2.depth + 1u)
+					info->depth = info2.depth + 1u;
+				if (pattern2_end == extended_pattern.end)
+					break;
+				pattern2 = pattern2_end + 1;
+			}
+			if (extended_pattern.count.max == 0u) {  /* !(...) */
+				character_byte_bitset_add_all(&first);
+				nullable = extended_pattern.total_len.min == 0u;
+				multiplier = &linear;
+			}
+			else if (extended_pattern.count.max > 1u) {
+				/* *(...) and +(...)
+				 */
+				if (extended_pattern.count.min == 0u)
+					nullable = true;
+				multiplier =
+					fixed_len &&
+					extended_pattern.match_len.min > 0u &&
+					!overlapping &&
+					!cost.unbounded
+						? &linear
+						: &exponential;
+			}
+			else {  /* ?(...) and @(...)
+				 */
+				if (extended_pattern.count.min == 0u)
+					nullable = true;
+				if (
+					extended_pattern.total_len.min !=
+					extended_pattern.total_len.max
+					)
+					multiplier = &linear;
+			}
+			if (multiplier != &one)
+				committing_wildcard = false;
+			break;
+		}
+		case WILDCARD_PATTERN_MATCH_ANY:
+			character_byte_bitset_add_all(&first);
+			nullable = true;
+			wildcard = true;
+			/* Consecutive wildcard patterns are processed
+			 * together.
+			 */
+			if (previous_wildcard)
+				break;
+			if (committing_wildcard)
+				split_points = split_points_before_wildcard;
+			split_points_before_wildcard = split_points;
+			committing_wildcard = true;
+			multiplier = &linear;
+			break;
+		case WILDCARD_PATTERN_MATCH_ONE:
+			character_byte_bitset_add_all(&first);
+			wildcard = previous_wildcard;
+			break;
+		case CHARACTER_BYTE_CLASS_PATTERN:
+			character_byte_bitset_add_class(
+				&first,
+				&character_byte_class
+				);
+			break;
+		case CHARACTER_BYTE_PATTERN:
+			character_byte_bitset_add(&first, character_byte);
+			break;
+		case PATTERN_SEPARATOR_PATTERN:
+			character_byte_bitset_add(&first, character_byte);
+			break;
+		case TOKEN_SEPARATOR_PATTERN:
+			character_byte_bitset_add(&first, character_byte);
+			/* The backtracking does not cross token separators.
+			 */
+			split_points = one;
+			committing_wildcard = false;
+			break;
+		}
+		previous_wildcard = wildcard;
+		multiply_pattern_complexity_bound(&split_points, multiplier);
+		multiply_pattern_complexity_bound(&cost, &split_points);
+		add_pattern_complexity_bound(&info->steps, &cost);
+		if (first_open) {
+			character_byte_bitset_add_bitset(&info->first, &first);
+			if (!nullable) {
+				first_open = false;
+				info->nullable = false;
+			}
+		}
+	}
+	if (!info->steps.factor)
+		info->steps = one;
+}
+
+#endif  /* PATTERN_COMPLEXITY_H */
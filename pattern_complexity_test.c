@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#undef NDEBUG
+
+#include <stdio.h>
+
+#include "pattern_complexity.h"
+
+struct pattern_complexity_test_data {
+	char const *pattern;
+	unsigned expected_degree;
+	unsigned expected_unbounded;
+	unsigned expected_depth;
+};
+
+static struct pattern_complexity_test_data const test_data[] = {
+	{"", 0u, 0u, 0u},
+	{"publickey", 0u, 0u, 0u},
+	{"publickey=ssh-ed25519", 0u, 0u, 0u},
+	{"[a-z]?[!a-z]", 0u, 0u, 0u},
+	{"*", 1u, 0u, 0u},
+	{"**?*", 1u, 0u, 0u},
+	{"publickey=*sk-*@openssh.com", 1u, 0u, 0u},
+	{"*=*=*", 1u, 0u, 0u},
+	{"* * *", 1u, 0u, 0u},
+	{"publickey=@(ssh-dss|ssh-rsa)", 0u, 0u, 1u},
+	{"publickey=@(ssh-ed25519|ssh-rsa)", 1u, 0u, 1u},
+	{"publickey=@(a|ab)*", 2u, 0u, 1u},
+	{"!(password)", 1u, 0u, 1u},
+	{"+(ab)", 1u, 0u, 1u},
+	{"*([a-z]|[0-9])", 1u, 0u, 1u},
+	{"*(a|ab)", 0u, 1u, 1u},
+	{"*(a|a)", 0u, 1u, 1u},
+	{"*(?(a))", 1u, 1u, 2u},
+	{"*(*(a))", 1u, 1u, 2u},
+	{"*(*(?))x", 1u, 1u, 2u},
+	{NULL, 0u, 0u, 0u}
+};
+
+int
+main() {
+	static struct character_byte_set const pattern_separators = {1, "="};
+	static struct character_byte_set const token_separators = {1, " "};
+	for (int i = 0; test_data[i].pattern; ++i) {
+		char const *const pattern = test_data[i].pattern;
+		struct pattern_complexity_info info;
+		analyze_pattern_complexity(
+			pattern,
+			pattern + strlen(pattern),
+			&pattern_separators,
+			&token_separators,
+			&info
+			);
+		fprintf(
+			stderr,
+			"analyze_pattern_complexity(\"%s\", ...)"
+			", steps.degree == %u %s %u"
+			", steps.unbounded == %u %s %u"
+			", depth == %u %s %u"
+			"\n",
+			pattern,
+			info.steps.degree,
+			info.steps.degree == test_data[i].expected_degree
+				? "=="
+				: "!=",
+			test_data[i].expected_degree,
+			info.steps.unbounded,
+			info.steps.unbounded ==
+				test_data[i].expected_unbounded
+				? "=="
+				: "!=",
+			test_data[i].expected_unbounded,
+			info.depth,
+			info.depth == test_data[i].expected_depth
+				? "=="
+				: "!=",
+			test_data[i].expected_depth
+			);
+		if (info.steps.degree != test_data[i].expected_degree)
+			return 1;
+		if (info.steps.unbounded != test_data[i].expected_unbounded)
+			return 1;
+		if (info.depth != test_data[i].expected_depth)
+			return 1;
+		/* The bound must be monotonic in the tokens length.
+		 */
+		size_t const steps_short = evaluate_pattern_complexity_bound(
+			&info.steps,
+			16u,
+			6u
+			);
+		size_t const steps_long = evaluate_pattern_complexity_bound(
+			&info.steps,
+			1024u,
+			6u
+			);
+		if (steps_short > steps_long)
+			return 1;
+	}
+	fprintf(stderr, "OK\n");
+	return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_COST_H
+#define PATTERN_COST_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pattern.h"
+#include "pattern_arithmetic.h"
+
+struct pattern_cost_info {
+	size_t cost;
+	size_t literals;
+};
+
+/* Estimate the relative cost of matching a pattern and
+ * the minimum number of literal character bytes the pattern requires
+ * (the more literal character bytes, the more selective the pattern).
+ *
+ * The estimate is based on the number of pattern entities,
+ * on the length bounds of the extended patterns and
+ * on the nesting of the extended patterns.
+ * Variable length entities multiply the cost because they make
+ * the matcher try multiple split points.
+ */
+static void
+estimate_pattern_cost(
+	char const *pattern,
+	char const *const pattern_end,
+	struct pattern_cost_info *const info
+	) {
+	assert(pattern <= pattern_end);
+	size_t variable_len_entities = 0u;
+	info->cost = info->literals = 0u;
+	while (pattern < pattern_end) {
+		char character_byte;
+		struct character_byte_class_info character_byte_class;
+		struct extended_pattern_info extended_pattern;
+		struct wildcard_pattern_info wildcard_pattern;
+		bool const measure_extended_patterns_on = true;
+		switch (parse_next_pattern_entity(
+			&pattern,
+			pattern_end,
+			NULL,
+			NULL,
+			&character_byte,
+			&character_byte_class,
+			&extended_pattern,
+			&wildcard_pattern,
+			measure_extended_patterns_on
+			)) {
+		case EXTENDED_PATTERN: {
+			/* Every alternative is tried (recursively).
+			 */
+			size_t cost = 1u;
+			size_t literals = SIZE_MAX;
+			for (char const *pattern2 = extended_pattern.begin;;) {
+				struct pattern_cost_info info2;
+				char const *const pattern2_end =
+					find_in_pattern(
+						pattern2,
+						extended_pattern.end,
+						'|',
+						extended_pattern.end
+						);
+				estimate_pattern_cost(
+					pattern2,
+					pattern2_end,
+					&info2
+					);
+				cost = add_saturating(cost, info2.cost);
+				if (literals > info2.literals)
+					literals = info2.literals;
+				if (pattern2_end == extended_pattern.end)
+					break;
+				pattern2 = pattern2_end + 1;
+			}
+			if (extended_pattern.count.max != 1u)
+				/* Repetitions and negations are tried at
+				 * multiple split points.
+				 */
+				cost = multiply_saturating(cost, 4u);
+			if (
+				extended_pattern.total_len.min !=
+				extended_pattern.total_len.max
+				)
+				++variable_len_entities;
+			info->cost = add_saturating(info->cost, cost);
+			info->literals = add_saturating(
+				info->literals,
+				multiply_saturating(
+					literals,
+					extended_pattern.count.min
+					)
+				);
+			continue;
+		}
+		case WILDCARD_PATTERN_MATCH_ANY:
+			++variable_len_entities;
+			info->cost = add_saturating(info->cost, 4u);
+			continue;
+		case CHARACTER_BYTE_PATTERN:
+			info->literals = add_saturating(info->literals, 1u);
+			break;
+		case WILDCARD_PATTERN_MATCH_ONE:
+		case CHARACTER_BYTE_CLASS_PATTERN:
+			break;
+		case PATTERN_SEPARATOR_PATTERN:
+		case TOKEN_SEPARATOR_PATTERN:
+			assert(false);
+		}
+		info->cost = add_saturating(info->cost, 1u);
+	}
+	for (; variable_len_entities > 1u; --variable_len_entities)
+		info->cost = multiply_saturating(info->cost, 2u);
+}
+
+#endif  /* PATTERN_COST_H */
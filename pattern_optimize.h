@@ -0,0 +1,483 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_OPTIMIZE_H
+#define PATTERN_OPTIMIZE_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "pattern.h"
+
+struct pattern_optimize_context {
+	struct character_byte_set const *pattern_separators;
+	struct character_byte_set const *token_separators;
+};
+
+/* Check if a character byte is a plain character byte which has the same
+ * meaning both within and outside of an extended pattern and regardless of
+ * the surrounding character bytes.
+ */
+static bool
+is_plain_pattern_character_byte(
+	struct pattern_optimize_context const *const context,
+	char const ch
+	) {
+	if (!ch || strchr("!()*+?@[\\]|", ch))
+		return false;
+	if (context->pattern_separators && in_character_byte_set(
+		context->pattern_separators,
+		ch
+		))
+		return false;
+	if (context->token_separators && in_character_byte_set(
+		context->token_separators,
+		ch
+		))
+		return false;
+	return true;
+}
+
+/* Check if the pattern list of an extended pattern can be unwrapped,
+ * that is if @(pattern) can be replaced with pattern.
+ */
+static bool
+can_unwrap_pattern_list(
+	struct pattern_optimize_context const *const context,
+	char const *const begin,
+	char const *const end,
+	char const *const next,
+	char const *const pattern_end
+	) {
+	if (begin >= end)
+		/* The previous character byte could introduce
+		 * an extended pattern with the next character byte and
+		 * empty extended patterns can match differently at token
+		 * boundaries.
+		 */
+		return false;
+	if (*begin == '(')
+		/* The previous character byte could introduce
+		 * an extended pattern.
+		 */
+		return false;
+	if (
+		strchr("!*+?@", end[-1]) &&
+		next < pattern_end &&
+		*next == '('
+		)
+		/* The last character byte could introduce
+		 * an extended pattern.
+		 */
+		return false;
+	if (next < pattern_end && (
+		memchr(begin, '*', (size_t)(end - begin)) ||
+		memchr(begin, '?', (size_t)(end - begin))
+		))
+		/* The matcher matches wildcard patterns differently
+		 * depending on the patterns following them.
+		 * Keep wildcard patterns isolated from the following
+		 * patterns in order to keep matching results unchanged.
+		 */
+		return false;
+	for (char const *p = begin; p < end; ++p) {
+		/* Character byte classes and escapes could extend beyond
+		 * the pattern list and separators have different meanings
+		 * within and outside of extended patterns.
+		 */
+		if (strchr("[\\]", *p))
+			return false;
+		if (context->pattern_separators && in_character_byte_set(
+			context->pattern_separators,
+			*p
+			))
+			return false;
+		if (context->token_separators && in_character_byte_set(
+			context->token_separators,
+			*p
+			))
+			return false;
+	}
+	return true;
+}
+
+/* Combine nested single pattern extended patterns.
+ * For example, *(+(pattern)) matches the same as *(pattern).
+ */
+static char
+combine_extended_pattern_types(char const outer, char const inner) {
+	if (outer == '@')
+		return inner;
+	if (inner == '@' || inner == outer)
+		return outer;
+	return '*';
+}
+
+/* Factor the common prefix and suffix out of the patterns of
+ * a @(pattern|pattern|...) extended pattern.
+ * For example, @(ssh-ed25519|ssh-ed448) is rewritten to ssh-ed@(25519|448).
+ * Returns the end of the rewritten extended pattern.
+ */
+static char *
+factor_pattern_list(
+	struct pattern_optimize_context const *const context,
+	char *const group,
+	char *const list_end
+	) {
+	char *const list = group + 2;
+	size_t prefix_len = SIZE_MAX;
+	size_t suffix_len = SIZE_MAX;
+	size_t min_len = SIZE_MAX;
+	char const *const first = list;
+	char const *const first_end = find_in_pattern(
+		list,
+		list_end,
+		'|',
+		list_end
+		);
+	for (char const *p = list;;) {
+		char const *const p_end = find_in_pattern(
+			p,
+			list_end,
+			'|',
+			list_end
+			);
+		size_t const len = (size_t)(p_end - p);
+		size_t const first_len = (size_t)(first_end - first);
+		size_t n = 0u;
+		while (
+			n < prefix_len &&
+			n < len &&
+			n < first_len &&
+			p[n] == first[n] &&
+			is_plain_pattern_character_byte(context, p[n])
+			)
+			++n;
+		prefix_len = n;
+		n = 0u;
+		while (
+			n < suffix_len &&
+			n < len &&
+			n < first_len &&
+			p_end[-1 - (ptrdiff_t)n] ==
+				first_end[-1 - (ptrdiff_t)n] &&
+			is_plain_pattern_character_byte(
+				context,
+				p_end[-1 - (ptrdiff_t)n]
+				)
+			)
+			++n;
+		suffix_len = n;
+		if (min_len > len)
+			min_len = len;
+		if (p_end == list_end)
+			break;
+		p = p_end + 1;
+	}
+	if (prefix_len > min_len)
+		prefix_len = min_len;
+	if (suffix_len > min_len - prefix_len)
+		suffix_len = min_len - prefix_len;
+	/* Do not split backslash escapes.
+	 */
+	for (char const *p = list; suffix_len > 0u;) {
+		char const *const p_end = find_in_pattern(
+			p,
+			list_end,
+			'|',
+			list_end
+			);
+		if ((size_t)(p_end - p) > suffix_len && (
+			p_end[-1 - (ptrdiff_t)suffix_len] == '\\'
+			)) {
+			--suffix_len;
+			p = list;
+			continue;
+		}
+		if (p_end == list_end)
+			break;
+		p = p_end + 1;
+	}
+	if (!prefix_len && !suffix_len)
+		return list_end + 1;
+	/* Rewrite in place.
+	 * The rewritten extended pattern is shorter than the original one
+	 * and the destination never overtakes the source.
+	 * However, the prefix of the first pattern is overwritten and
+	 * therefore the prefixes are skipped when searching for the ends of
+	 * the patterns (the prefixes consist of plain character bytes).
+	 */
+	char *out = group;
+	memmove(out, list, prefix_len);
+	out += prefix_len;
+	*out++ = '@';
+	*out++ = '(';
+	for (char *p = list;;) {
+		char *const p_end = (char *)find_in_pattern(
+			p + prefix_len,
+			list_end,
+			'|',
+			list_end
+			);
+		size_t const len = (size_t)(p_end - p);
+		memmove(out, p + prefix_len, len - prefix_len - suffix_len);
+		out += len - prefix_len - suffix_len;
+		if (p_end == list_end) {
+			memmove(out + 1, p_end - suffix_len, suffix_len);
+			*out++ = ')';
+			out += suffix_len;
+			return out;
+		}
+		*out++ = '|';
+		p = p_end + 1;
+	}
+}
+
+static char *
+optimize_pattern_once(
+	struct pattern_optimize_context const *const context,
+	char const *pattern,
+	char const *const pattern_end,
+	char *out
+	);
+
+/* Optimize an extended pattern.
+ * Returns the end of the optimized pattern.
+ */
+static char *
+optimize_extended_pattern(
+	struct pattern_optimize_context const *const context,
+	struct extended_pattern_info const *const info,
+	char const *const next,
+	char const *const pattern_end,
+	char *out
+	) {
+	static struct pattern_optimize_context const inner_context = {
+		NULL,
+		NULL
+	};
+	char const type = info->begin[-2];
+	char *const group = out;
+	*out++ = type;
+	*out++ = '(';
+	char *const list = out;
+	for (char const *p = info->begin;;) {
+		char const *const p_end = find_in_pattern(
+			p,
+			info->end,
+			'|',
+			info->end
+			);
+		char *const separator = out;
+		if (p > info->begin)
+			*out++ = '|';
+		char *const item = out;
+		out = optimize_pattern_once(&inner_context, p, p_end, out);
+		/* Remove duplicate patterns.
+		 */
+		for (char const *q = list; p > info->begin;) {
+			char const *const q_end = find_in_pattern(
+				q,
+				separator,
+				'|',
+				separator
+				);
+			if (
+				q_end - q == out - item &&
+				memcmp(q, item, (size_t)(out - item)) == 0
+				) {
+				out = separator;
+				break;
+			}
+			if (q_end == separator)
+				break;
+			q = q_end + 1;
+		}
+		if (p_end == info->end)
+			break;
+		p = p_end + 1;
+	}
+	char *list_end = out;
+	*out++ = ')';
+	for (;;) {
+		char const *p = list;
+		char character_byte;
+		struct character_byte_class_info character_byte_class;
+		struct extended_pattern_info inner;
+		struct wildcard_pattern_info wildcard_pattern;
+		bool const measure_extended_patterns_off = false;
+		if (find_in_pattern(list, list_end, '|', NULL)) {
+			if (group[0] == '@')
+				return factor_pattern_list(
+					context,
+					group,
+					list_end
+					);
+			return out;
+		}
+		if (!strchr("*+?@", group[0]))
+			return out;
+		if (list < list_end && parse_next_pattern_entity(
+			&p,
+			list_end,
+			NULL,
+			NULL,
+			&character_byte,
+			&character_byte_class,
+			&inner,
+			&wildcard_pattern,
+			measure_extended_patterns_off
+			) == EXTENDED_PATTERN && p == list_end && (
+			strchr("*+?@", list[0])
+			)) {
+			/* Combine nested extended patterns.
+			 */
+			group[0] = combine_extended_pattern_types(
+				group[0],
+				list[0]
+				);
+			size_t const inner_len =
+				(size_t)(inner.end - inner.begin);
+			memmove(list, inner.begin, inner_len);
+			list_end = list + inner_len;
+			out = list_end;
+			*out++ = ')';
+			continue;
+		}
+		if (group[0] == '@' && can_unwrap_pattern_list(
+			context,
+			list,
+			list_end,
+			next,
+			pattern_end
+			)) {
+			memmove(group, list, (size_t)(list_end - list));
+			return group + (list_end - list);
+		}
+		return out;
+	}
+}
+
+static char *
+optimize_pattern_once(
+	struct pattern_optimize_context const *const context,
+	char const *pattern,
+	char const *const pattern_end,
+	char *out
+	) {
+	assert(pattern <= pattern_end);
+	bool previous_wildcard = false;
+	while (pattern < pattern_end) {
+		char const *const entity = pattern;
+		char character_byte;
+		struct character_byte_class_info character_byte_class;
+		struct extended_pattern_info extended_pattern;
+		struct wildcard_pattern_info wildcard_pattern;
+		bool const measure_extended_patterns_off = false;
+		bool wildcard = false;
+		switch (parse_next_pattern_entity(
+			&pattern,
+			pattern_end,
+			context->pattern_separators,
+			context->token_separators,
+			&character_byte,
+			&character_byte_class,
+			&extended_pattern,
+			&wildcard_pattern,
+			measure_extended_patterns_off
+			)) {
+		case EXTENDED_PATTERN:
+			out = optimize_extended_pattern(
+				context,
+				&extended_pattern,
+				pattern,
+				pattern_end,
+				out
+				);
+			break;
+		case WILDCARD_PATTERN_MATCH_ANY:
+			wildcard = true;
+			if (previous_wildcard)
+				/* Consecutive asterisks (**) match the same as
+				 * a single asterisk (*).
+				 */
+				break;
+			/* FALLTHROUGH */
+		default:
+			memmove(out, entity, (size_t)(pattern - entity));
+			out += pattern - entity;
+			break;
+		}
+		previous_wildcard = wildcard;
+	}
+	return out;
+}
+
+/* Optimize a pattern by rewriting it to a shorter pattern which matches
+ * the same tokens:
+ *  - consecutive asterisks (**) are collapsed to a single asterisk (*),
+ *  - nested single pattern extended patterns (such as *(*(pattern))) are
+ *    combined (to *(pattern)),
+ *  - single pattern @(pattern) extended patterns are unwrapped when
+ *    the pattern has the same meaning outside of the extended pattern,
+ *  - duplicate patterns in extended patterns (such as ?(a|a)) are removed and
+ *  - common literal prefixes and suffixes are factored out of
+ *    @(pattern|pattern|...) extended patterns.
+ *
+ * The optimized pattern is never longer than the original pattern and it may
+ * overwrite the original pattern (optimized may be equal to pattern).
+ * Returns the end of the optimized pattern.
+ */
+static char *
+optimize_pattern(
+	char const *const pattern,
+	char const *const pattern_end,
+	struct character_byte_set const *const pattern_separators,
+	struct character_byte_set const *const token_separators,
+	char *const optimized
+	) {
+	assert(pattern <= pattern_end);
+	struct pattern_optimize_context const context = {
+		pattern_separators,
+		token_separators
+	};
+	char *optimized_end = optimize_pattern_once(
+		&context,
+		pattern,
+		pattern_end,
+		optimized
+		);
+	/* Every rewrite shortens the pattern.
+	 * Therefore, repeat until the length no longer changes.
+	 */
+	for (;;) {
+		char *const end = optimize_pattern_once(
+			&context,
+			optimized,
+			optimized_end,
+			optimized
+			);
+		if (end == optimized_end)
+			return optimized_end;
+		optimized_end = end;
+	}
+}
+
+#endif  /* PATTERN_OPTIMIZE_H */
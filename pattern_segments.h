@@ -0,0 +1,196 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_SEGMENTS_H
+#define PATTERN_SEGMENTS_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "pattern.h"
+
+/* A part of a pattern between separator patterns.
+ */
+struct pattern_segment {
+	struct pattern_length_info len;
+	/* Whether the segment is followed by a token separator pattern
+	 * (rather than by a pattern separator pattern or by the end of
+	 * the pattern).
+	 */
+	bool token_separator_follows;
+};
+
+struct pattern_segments {
+	size_t len;
+	struct pattern_segment const *ptr;
+};
+
+/* Split a pattern to segments at the separator patterns and measure
+ * the segments.
+ * At most max_segments segments are stored but the total number of
+ * the segments is returned.
+ */
+static size_t
+measure_pattern_segments(
+	char const *pattern,
+	char const *const pattern_end,
+	struct character_byte_set const *const pattern_separators,
+	struct character_byte_set const *const token_separators,
+	struct pattern_segment *const segments,
+	size_t const max_segments
+	) {
+	assert(pattern <= pattern_end);
+	size_t n = 0u;
+	for (char const *segment = pattern;;) {
+		enum pattern_type type = CHARACTER_BYTE_PATTERN;
+		char const *segment_end = pattern;
+		while (pattern < pattern_end) {
+			char character_byte;
+			struct character_byte_class_info character_byte_class;
+			struct extended_pattern_info extended_pattern;
+			struct wildcard_pattern_info wildcard_pattern;
+			bool const measure_extended_patterns_off = false;
+			segment_end = pattern;
+			type = parse_next_pattern_entity(
+				&pattern,
+				pattern_end,
+				pattern_separators,
+				token_separators,
+				&character_byte,
+				&character_byte_class,
+				&extended_pattern,
+				&wildcard_pattern,
+				measure_extended_patterns_off
+				);
+			if (
+				type == PATTERN_SEPARATOR_PATTERN ||
+				type == TOKEN_SEPARATOR_PATTERN
+				)
+				break;
+			segment_end = pattern;
+		}
+		bool const separator_follows =
+			type == PATTERN_SEPARATOR_PATTERN ||
+			type == TOKEN_SEPARATOR_PATTERN;
+		if (n < max_segments) {
+			measure_pattern(segment, segment_end, &segments[n].len);
+			segments[n].token_separator_follows =
+				type == TOKEN_SEPARATOR_PATTERN;
+		}
+		++n;
+		if (!separator_follows)
+			return n;
+		segment = pattern;
+	}
+}
+
+/* Check if the tokens can match a pattern based on the lengths of
+ * the pattern segments and of the tokens alone.
+ *
+ * Every separator pattern matches one character byte and the segments
+ * cannot match token separators. Therefore, every token matches one or
+ * more consecutive segments separated by pattern separator patterns which
+ * match pattern separator character bytes within the token.
+ * Returns false only if the tokens cannot match.
+ * Patterns with more than 64 segments are not checked.
+ */
+static bool
+tokens_fit_pattern_segments(
+	struct pattern_segments const *const segments,
+	struct character_byte_set const *const pattern_separators,
+	struct character_byte_set const *const token_separators,
+	char const *tokens,
+	char const *const tokens_end,
+	bool const allow_prefix_match
+	) {
+	assert(tokens <= tokens_end);
+	size_t const n = segments->len;
+	if (n == 0u || n > 64u)
+		return true;
+	/* The segments which can begin the current token.
+	 */
+	uint_least64_t reachable = 1u;
+	for (;;) {
+		char const *token_end = tokens;
+		size_t pattern_separator_count = 0u;
+		for (; token_end < tokens_end; ++token_end) {
+			if (in_character_byte_set(token_separators, *token_end))
+				break;
+			if (in_character_byte_set(
+				pattern_separators,
+				*token_end
+				))
+				++pattern_separator_count;
+		}
+		size_t const len = (size_t)(token_end - tokens);
+		bool const last = token_end >= tokens_end;
+		uint_least64_t next_reachable = 0u;
+		for (size_t i = 0u; i < n; ++i) {
+			if (!(reachable >> i & 1u))
+				continue;
+			size_t min = 0u;
+			size_t max = 0u;
+			for (size_t j = i; j < n; ++j) {
+				struct pattern_segment const *const segment =
+					&segments->ptr[j];
+				size_t const separator_len = j > i ? 1u : 0u;
+				min += segment->len.min + separator_len;
+				/* Ditto for the maximum,
+				 * but do not let it overflow.
+				 */
+				if (max < SIZE_MAX && (
+					segment->len.max <
+					SIZE_MAX - max - separator_len
+					))
+					max += segment->len.max + separator_len;
+				else
+					max = SIZE_MAX;
+				if (min > len)
+					break;
+				if (len <= max) {
+					if (j + 1u < n)
+						next_reachable |=
+							(uint_least64_t)1u <<
+							(j + 1u);
+					else if (allow_prefix_match || last)
+						/* The whole pattern can match
+						 * the tokens up to the end of
+						 * this token.
+						 */
+						return true;
+				}
+				/* Only pattern separator patterns can match
+				 * within a token.
+				 */
+				if (
+					segment->token_separator_follows ||
+					j - i >= pattern_separator_count
+					)
+					break;
+			}
+		}
+		if (last || !next_reachable)
+			return false;
+		reachable = next_reachable;
+		tokens = token_end + 1;
+	}
+}
+
+#endif  /* PATTERN_SEGMENTS_H */
@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_SET_H
+#define PATTERN_SET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pattern.h"
+#include "pattern_optimize.h"
+#include "pattern_segments.h"
+
+/* Preparing module argument patterns for matching
+ * (shared by pam_ssh_auth_info and libssh_auth_info_match).
+ */
+
+static struct character_byte_set const pattern_separators = {1, "="};
+static struct character_byte_set const token_separators = {1, " "};
+
+/* Check if a pattern is a regular expression pattern (re:...).
+ */
+static bool
+is_regular_expression_pattern(char const *const pattern) {
+	return strncmp(pattern, "re:", 3) == 0;
+}
+
+/* Optimize patterns (see optimize_pattern).
+ * Regular expression patterns are copied as is.
+ * Returns an array of the optimized patterns which must be freed with free
+ * or NULL if out of memory.
+ */
+static char const **
+optimize_patterns(int const argc, char const *const *const argv) {
+	size_t size = (size_t)argc * sizeof (char const *);
+	for (int i = 0; i < argc; ++i)
+		size += strlen(argv[i]) + 1u;
+	char const **const patterns = malloc(size ? size : 1u);
+	if (!patterns)
+		return NULL;
+	char *p = (char *)(patterns + argc);
+	for (int i = 0; i < argc; ++i) {
+		patterns[i] = p;
+		if (is_regular_expression_pattern(argv[i])) {
+			size_t const len = strlen(argv[i]);
+			memcpy(p, argv[i], len + 1u);
+			p += len + 1u;
+			continue;
+		}
+		p = optimize_pattern(
+			argv[i],
+			argv[i] + strlen(argv[i]),
+			&pattern_separators,
+			&token_separators,
+			p
+			);
+		*p++ = '\0';
+	}
+	return patterns;
+}
+
+/* Split patterns to segments (see measure_pattern_segments).
+ * Returns an array of the segments of the patterns which must be freed with
+ * free or NULL if out of memory.
+ */
+static struct pattern_segments *
+measure_patterns_segments(int const argc, char const *const *const patterns) {
+	size_t n = 0u;
+	for (int i = 0; i < argc; ++i)
+		n += measure_pattern_segments(
+			patterns[i],
+			patterns[i] + strlen(patterns[i]),
+			&pattern_separators,
+			&token_separators,
+			NULL,
+			0u
+			);
+	struct pattern_segments *const segments = malloc(
+		(size_t)argc * sizeof *segments +
+		n * sizeof (struct pattern_segment) +
+		1u
+		);
+	if (!segments)
+		return NULL;
+	struct pattern_segment *p =
+		(struct pattern_segment *)(segments + argc);
+	for (int i = 0; i < argc; ++i) {
+		segments[i].ptr = p;
+		segments[i].len = measure_pattern_segments(
+			patterns[i],
+			patterns[i] + strlen(patterns[i]),
+			&pattern_separators,
+			&token_separators,
+			p,
+			SIZE_MAX
+			);
+		p += segments[i].len;
+	}
+	return segments;
+}
+
+#endif  /* PATTERN_SET_H */
@@ -0,0 +1,680 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_SET_MATCH_H
+#define PATTERN_SET_MATCH_H
+
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pam_options.h"
+#include "pattern_analyze.h"
+#include "pattern_cost.h"
+#include "pattern_segments.h"
+#include "pattern_set.h"
+#include "pattern_trie_compile.h"
+#include "tokens_match.h"
+#ifdef HAVE_PCRE2
+#	include "regular_expression_match.h"
+#else
+struct regular_expression;
+#endif
+
+/* Evaluating module argument patterns against SSH authentication information
+ * (shared by pam_ssh_auth_info and libssh_auth_info_match).
+ */
+
+#define BITMAP_WORD_BITS (CHAR_BIT * sizeof (unsigned long))
+#define BITMAP_WORDS(n_bits) \
+	(((n_bits) + BITMAP_WORD_BITS - 1u) / BITMAP_WORD_BITS)
+
+static bool
+bitmap_test(unsigned long const *const bitmap, size_t const i) {
+	return (bitmap[i / BITMAP_WORD_BITS] >> (i % BITMAP_WORD_BITS)) & 1u;
+}
+
+static void
+bitmap_set(unsigned long *const bitmap, size_t const i) {
+	bitmap[i / BITMAP_WORD_BITS] |= 1ul << (i % BITMAP_WORD_BITS);
+}
+
+static size_t
+bitmap_count(unsigned long const *const bitmap, size_t const n_words) {
+	size_t count = 0u;
+	for (size_t i = 0u; i < n_words; ++i) {
+#if defined(__GNUC__)
+		count += (size_t)__builtin_popcountl(bitmap[i]);
+#else
+		for (unsigned long word = bitmap[i]; word; word &= word - 1u)
+			++count;
+#endif
+	}
+	return count;
+}
+
+/* An evaluation order entry.
+ */
+struct pattern_order_entry {
+	int index;
+	size_t cost;
+	size_t literals;
+	bool prefer_literals;
+};
+
+static int
+compare_pattern_order_entries(void const *const a, void const *const b) {
+	struct pattern_order_entry const *const x = a;
+	struct pattern_order_entry const *const y = b;
+	if (x->cost != y->cost)
+		return x->cost < y->cost ? -1 : 1;
+	/* Patterns with more literal character bytes are less likely to match.
+	 */
+	if (x->literals != y->literals)
+		return (x->literals > y->literals) == x->prefer_literals
+			? -1
+			: 1;
+	return x->index < y->index ? -1 : x->index > y->index;
+}
+
+/* Order patterns so that the cheapest patterns which are the most likely to
+ * be decisive are evaluated first.
+ *
+ * If prefer_literals is true, a non-match is decisive and patterns with more
+ * literal character bytes are preferred over equally costly patterns with
+ * fewer literal character bytes.
+ * Otherwise, a match is decisive and the opposite preference applies.
+ */
+static struct pattern_order_entry *
+order_patterns(
+	int const argc,
+	char const *const *const argv,
+	bool const prefer_literals
+	) {
+	struct pattern_order_entry *const order = calloc(
+		(size_t)argc + 1u,
+		sizeof *order
+		);
+	if (!order)
+		return NULL;
+	for (int i = 0; i < argc; ++i) {
+		struct pattern_cost_info cost;
+		estimate_pattern_cost(
+			argv[i],
+			argv[i] + strlen(argv[i]),
+			&cost
+			);
+		order[i].index = i;
+		order[i].cost = cost.cost;
+		order[i].literals = cost.literals;
+		order[i].prefer_literals = prefer_literals;
+	}
+	qsort(
+		order,
+		(size_t)argc,
+		sizeof *order,
+		compare_pattern_order_entries
+		);
+	return order;
+}
+
+/* A set of preprocessed patterns and the match style options.
+ */
+struct pattern_set {
+	enum match_style match_style;
+	size_t match_count;
+	unsigned re_match_limit;
+	unsigned recursion_limit;
+	int n_patterns;
+	bool any_regular_expressions;
+	/* The optimized patterns and their lengths.
+	 */
+	char const **patterns;
+	size_t *pattern_lens;
+	struct pattern_segments *segments;
+	struct pattern_tries *tries;
+	struct pattern_analysis *analysis;
+	/* The compiled regular expressions (or NULL per pattern).
+	 */
+	struct regular_expression **res;
+	/* The evaluation order or NULL (see the reorder option).
+	 */
+	struct pattern_order_entry *order;
+};
+
+/* Destroy a pattern set (even if pattern_set_init failed).
+ */
+static void
+pattern_set_destroy(struct pattern_set *const set) {
+#ifdef HAVE_PCRE2
+	for (int i = 0; set->res && i < set->n_patterns; ++i)
+		destroy_regular_expression(set->res[i]);
+#endif
+	free(set->res);
+	free(set->order);
+	free(set->analysis);
+	free(set->tries);
+	free(set->segments);
+	free(set->pattern_lens);
+	free(set->patterns);
+}
+
+/* Compile the regular expression patterns (re:...) of a pattern set.
+ * If anchored, they must match whole lines (see compile_regular_expression).
+ * Returns false on error (with an error message in the error buffer).
+ */
+static bool
+pattern_set_compile_regular_expressions(
+	struct pattern_set *const set,
+	bool const anchored,
+	char const *const *const argv,
+	char *const error,
+	size_t const error_size
+	) {
+	for (int i = 0; i < set->n_patterns; ++i) {
+		if (!is_regular_expression_pattern(argv[i]))
+			continue;
+		set->any_regular_expressions = true;
+#ifdef HAVE_PCRE2
+		char message[512];
+		if (!(set->res[i] = compile_regular_expression(
+			argv[i] + 3,
+			anchored,
+			message,
+			sizeof message
+			))) {
+			snprintf(
+				error,
+				error_size,
+				"regular expression pattern \"%s\": %s",
+				argv[i],
+				message
+				);
+			return false;
+		}
+#else
+		(void)anchored;
+		snprintf(
+			error,
+			error_size,
+			"regular expression pattern \"%s\""
+			" not supported (built without PCRE2)",
+			argv[i]
+			);
+		return false;
+#endif
+	}
+	return true;
+}
+
+/* Initialize a pattern set from patterns and parsed module options.
+ * The patterns are optimized, measured, compiled to tries and (if
+ * the reorder option is given) ordered.
+ * The patterns need not outlive the pattern set.
+ * The pattern set must be destroyed with pattern_set_destroy (also on error).
+ * Returns 0 or an error number (ENOMEM or EINVAL for an invalid pattern with
+ * an error message in the error buffer).
+ */
+static int
+pattern_set_init(
+	struct pattern_set *const set,
+	struct pam_options const *const options,
+	int const argc,
+	char const *const *const argv,
+	char *const error,
+	size_t const error_size
+	) {
+	memset(set, 0, sizeof *set);
+	set->match_style = options->match_style;
+	set->match_count = options->match_count;
+	set->re_match_limit = options->re_match_limit;
+	set->recursion_limit = options->recursion_limit;
+	set->n_patterns = argc;
+	if (
+		!(set->patterns = optimize_patterns(argc, argv)) ||
+		!(set->pattern_lens = calloc(
+			(size_t)argc + 1u,
+			sizeof *set->pattern_lens
+			)) ||
+		!(set->segments = measure_patterns_segments(
+			argc,
+			set->patterns
+			)) ||
+		!(set->tries = compile_pattern_tries(argc, set->patterns)) ||
+		!(set->analysis = analyze_patterns(
+			argc,
+			set->patterns,
+			&pattern_separators,
+			&token_separators
+			)) ||
+		!(set->res = calloc((size_t)argc + 1u, sizeof *set->res)) ||
+		(options->reorder && argc > 1 &&
+			!(set->order = order_patterns(
+				argc,
+				set->patterns,
+				options->match_style == MATCH_ALL_OF
+				)))
+		) {
+		snprintf(error, error_size, "out of memory");
+		return ENOMEM;
+	}
+	for (int i = 0; i < argc; ++i)
+		set->pattern_lens[i] = strlen(set->patterns[i]);
+	if (!pattern_set_compile_regular_expressions(
+		set,
+		!options->re_unanchored,
+		argv,
+		error,
+		error_size
+		))
+		return EINVAL;
+	return 0;
+}
+
+/* The match data and the match context of regular expressions.
+ * The compiled regular expressions are shared but the match data and
+ * the match context are per scratch so that a pattern set can be used
+ * concurrently (with a scratch per thread).
+ */
+struct pattern_set_scratch {
+#ifdef HAVE_PCRE2
+	struct regular_expression re;
+#else
+	char unused;
+#endif
+};
+
+/* Initialize a scratch for matching a pattern set.
+ * Returns false if out of memory.
+ */
+static bool
+pattern_set_scratch_init(
+	struct pattern_set const *const set,
+	struct pattern_set_scratch *const scratch
+	) {
+	memset(scratch, 0, sizeof *scratch);
+#ifdef HAVE_PCRE2
+	if (!set->any_regular_expressions)
+		return true;
+	if (
+		!(scratch->re.match_data = pcre2_match_data_create(1u, NULL)) ||
+		!(scratch->re.match_context = pcre2_match_context_create(NULL))
+		) {
+		pcre2_match_data_free(scratch->re.match_data);
+		scratch->re.match_data = NULL;
+		return false;
+	}
+#else
+	(void)set;
+#endif
+	return true;
+}
+
+/* Destroy a scratch (even if pattern_set_scratch_init failed).
+ */
+static void
+pattern_set_scratch_destroy(struct pattern_set_scratch *const scratch) {
+#ifdef HAVE_PCRE2
+	pcre2_match_context_free(scratch->re.match_context);
+	pcre2_match_data_free(scratch->re.match_data);
+#else
+	(void)scratch;
+#endif
+}
+
+/* Check if a pattern matches (a part of) a line.
+ *
+ * The line is matched against the optimized pattern.
+ * The lines whose token lengths do not fit the segments of the pattern are
+ * rejected without matching.
+ * A regular expression pattern is matched using the compiled regular
+ * expression instead.
+ * Like with the recursion limit, a line exceeding the match limit of
+ * a regular expression does not match.
+ * Returns 1 if the line matches, 0 if it does not match and a negative value
+ * if the match limit is exceeded or on other error (see
+ * regular_expression_line_match).
+ */
+static int
+pattern_set_match_line(
+	struct pattern_set const *const set,
+	struct pattern_set_scratch *const scratch,
+	size_t const i,
+	char const *const line,
+	char const *const line_end
+	) {
+#ifdef HAVE_PCRE2
+	if (set->res[i]) {
+		scratch->re.code = set->res[i]->code;
+		return regular_expression_line_match(
+			&scratch->re,
+			line,
+			line_end,
+			set->re_match_limit
+			);
+	}
+#else
+	(void)scratch;
+#endif
+	struct tokens_match_config const config = {
+		true,
+		{pattern_separators, token_separators},
+		set->tries,
+		set->analysis
+	};
+	if (!tokens_fit_pattern_segments(
+		&set->segments[i],
+		&pattern_separators,
+		&token_separators,
+		line,
+		line_end,
+		config.allow_prefix_match
+		))
+		return 0;
+	return tokens_match(
+		&config,
+		line,
+		line_end,
+		set->patterns[i],
+		set->patterns[i] + set->pattern_lens[i],
+		set->recursion_limit
+		);
+}
+
+/* The hooks for observing the evaluation of a pattern set.
+ *
+ * If match_line is not NULL, it is called instead of pattern_set_match_line
+ * (which it must call) for each evaluated line j of a pattern i so that
+ * the statistics, the trace, the timings and the debugging messages can be
+ * collected around the match.
+ */
+struct pattern_set_hooks {
+	int (*match_line)(
+		void *context,
+		struct pattern_set const *set,
+		struct pattern_set_scratch *scratch,
+		size_t i,
+		size_t j,
+		char const *line,
+		char const *line_end
+		);
+	void *context;
+};
+
+/* A pattern × line match matrix.
+ *
+ * A row per pattern and a column per SSH authentication information line.
+ * In addition, there is a summary row containing the lines which match any of
+ * the patterns and a bitmap of the evaluated rows.
+ */
+struct match_matrix {
+	size_t n_words;
+	unsigned long *rows;
+	unsigned long *any;
+	unsigned long *evaluated;
+};
+
+static bool
+match_matrix_init(
+	struct match_matrix *const matrix,
+	size_t const n_patterns,
+	size_t const n_lines
+	) {
+	matrix->n_words = BITMAP_WORDS(n_lines);
+	matrix->rows = calloc(
+		(n_patterns + 1u) * matrix->n_words +
+		BITMAP_WORDS(n_patterns) + 1u,
+		sizeof *matrix->rows
+		);
+	if (!matrix->rows)
+		return false;
+	matrix->any = matrix->rows + n_patterns * matrix->n_words;
+	matrix->evaluated = matrix->any + matrix->n_words;
+	return true;
+}
+
+/* Destroy a match matrix (even if match_matrix_init failed).
+ */
+static void
+match_matrix_destroy(struct match_matrix *const matrix) {
+	free(matrix->rows);
+}
+
+static unsigned long *
+match_matrix_row(struct match_matrix const *const matrix, size_t const i) {
+	return matrix->rows + i * matrix->n_words;
+}
+
+/* Locate the end of a line (a newline or the end).
+ */
+static char const *
+find_line_end(char const *const line, char const *const end) {
+	char const *const p = memchr(line, '\n', (size_t)(end - line));
+	return p ? p : end;
+}
+
+/* Count the lines of SSH authentication information.
+ * A trailing newline does not start a new line.
+ */
+static size_t
+count_ssh_auth_info_lines(char const *s, char const *const end) {
+	size_t n = 0u;
+	for (; s < end; ++n) {
+		char const *const line_end = find_line_end(s, end);
+		s = line_end < end ? line_end + 1 : end;
+	}
+	return n;
+}
+
+/* Fill in a row of the match matrix.
+ *
+ * If stop_at_first_match is true, the lines after the first matching line are
+ * left unevaluated.
+ * If skip_matched_lines is true, the lines which are already known to match
+ * some other pattern are left unevaluated.
+ * Returns true if any of the evaluated lines matches.
+ */
+static bool
+pattern_set_fill_row(
+	struct pattern_set const *const set,
+	struct pattern_set_scratch *const scratch,
+	struct pattern_set_hooks const *const hooks,
+	struct match_matrix const *const matrix,
+	size_t const i,
+	char const *const ssh_auth_info,
+	char const *const end,
+	bool const stop_at_first_match,
+	bool const skip_matched_lines
+	) {
+	unsigned long *const row = match_matrix_row(matrix, i);
+	bool any_matches = false;
+	size_t j = 0u;
+	bitmap_set(matrix->evaluated, i);
+	for (char const *s = ssh_auth_info; s < end; ++j) {
+		char const *const line_end = find_line_end(s, end);
+		char const *const line = s;
+		s = line_end < end ? line_end + 1 : end;
+		if (skip_matched_lines && bitmap_test(matrix->any, j))
+			continue;
+		bool const matches = (hooks && hooks->match_line
+			? hooks->match_line(
+				hooks->context,
+				set,
+				scratch,
+				i,
+				j,
+				line,
+				line_end
+				)
+			: pattern_set_match_line(
+				set,
+				scratch,
+				i,
+				line,
+				line_end
+				)) > 0;
+		if (!matches)
+			continue;
+		bitmap_set(row, j);
+		bitmap_set(matrix->any, j);
+		any_matches = true;
+		if (stop_at_first_match)
+			break;
+	}
+	return any_matches;
+}
+
+/* Find the same decisive pattern as without reordering, that is the first
+ * decisive pattern in the argument order, by evaluating the patterns
+ * preceding the decisive pattern which were left unevaluated (see
+ * pattern_set_evaluate).
+ * Returns the index of the decisive pattern.
+ */
+static int
+pattern_set_find_decisive_pattern(
+	struct pattern_set const *const set,
+	struct pattern_set_scratch *const scratch,
+	struct pattern_set_hooks const *const hooks,
+	struct match_matrix const *const matrix,
+	char const *const ssh_auth_info,
+	char const *const end,
+	int const decisive_index
+	) {
+	for (int i = 0; i < decisive_index; ++i) {
+		if (bitmap_test(matrix->evaluated, (size_t)i))
+			continue;
+		bool const matches = pattern_set_fill_row(
+			set,
+			scratch,
+			hooks,
+			matrix,
+			(size_t)i,
+			ssh_auth_info,
+			end,
+			true,
+			false
+			);
+		if (matches == (set->match_style != MATCH_ALL_OF))
+			return i;
+	}
+	return decisive_index;
+}
+
+/* Evaluate a pattern set against SSH authentication information using
+ * the match style.
+ *
+ * The match matrix is filled in lazily:
+ * the count based styles skip lines which are already counted and
+ * the other styles stop at the first matching line per pattern.
+ * The index of the decisive pattern (or -1 if there is none) is stored to
+ * decisive_index.
+ * With the reorder option, it is the first decisive pattern in
+ * the evaluation order unless the decisive pattern is needed on success
+ * (find_decisive_on_success) or on failure (find_decisive_on_failure), in
+ * which case it is the same decisive pattern as without reordering (see
+ * pattern_set_find_decisive_pattern).
+ * Returns true if the requirements are met.
+ */
+static bool
+pattern_set_evaluate(
+	struct pattern_set const *const set,
+	struct pattern_set_scratch *const scratch,
+	struct pattern_set_hooks const *const hooks,
+	struct match_matrix const *const matrix,
+	char const *const ssh_auth_info,
+	char const *const end,
+	bool const find_decisive_on_success,
+	bool const find_decisive_on_failure,
+	int *const decisive_index
+	) {
+	bool const count_lines_style =
+		set->match_style == MATCH_AT_LEAST ||
+		set->match_style == MATCH_EXACTLY;
+	bool success =
+		set->match_style == MATCH_ALL_OF ||
+		set->match_style == MATCH_NONE_OF ||
+		(count_lines_style && set->match_count == 0u);
+	*decisive_index = -1;
+	for (int n = 0; n < set->n_patterns; ++n) {
+		int const i = set->order ? set->order[n].index : n;
+		bool const matches = pattern_set_fill_row(
+			set,
+			scratch,
+			hooks,
+			matrix,
+			(size_t)i,
+			ssh_auth_info,
+			end,
+			!count_lines_style,
+			count_lines_style
+			);
+		size_t count;
+		switch (set->match_style) {
+		case MATCH_ALL_OF:
+			if (matches)
+				continue;
+			success = false;
+			*decisive_index = i;
+			break;
+		case MATCH_ANY_OF:
+			if (!matches)
+				continue;
+			success = true;
+			*decisive_index = i;
+			break;
+		case MATCH_AT_LEAST:
+			count = bitmap_count(matrix->any, matrix->n_words);
+			success = count >= set->match_count;
+			if (!success)
+				continue;
+			break;
+		case MATCH_EXACTLY:
+			count = bitmap_count(matrix->any, matrix->n_words);
+			success = count == set->match_count;
+			if (count <= set->match_count)
+				continue;
+			break;
+		case MATCH_NONE_OF:
+			if (!matches)
+				continue;
+			success = false;
+			*decisive_index = i;
+			break;
+		}
+		break;
+	}
+	if (set->order && *decisive_index > 0 && (success
+		? find_decisive_on_success
+		: find_decisive_on_failure
+		))
+		*decisive_index = pattern_set_find_decisive_pattern(
+			set,
+			scratch,
+			hooks,
+			matrix,
+			ssh_auth_info,
+			end,
+			*decisive_index
+			);
+	return success;
+}
+
+#endif  /* PATTERN_SET_MATCH_H */
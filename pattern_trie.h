@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_TRIE_H
+#define PATTERN_TRIE_H
+
+#include <assert.h>
+#include <limits.h>
+#include <stddef.h>
+
+/* A trie node.
+ * The children of a node form a singly linked list.
+ * Node 0 is the root and therefore a child index 0 means no child.
+ */
+struct pattern_trie_node {
+	unsigned first_child;
+	unsigned next_sibling;
+	/* The index of the first alternative ending at the node or
+	 * UINT_MAX.
+	 */
+	unsigned alternative;
+	char character_byte;
+};
+
+/* A trie of the alternatives of an extended pattern consisting of plain
+ * character bytes only (such as @(ssh-ed25519|ssh-rsa)).
+ */
+struct pattern_trie {
+	/* The beginning of the extended pattern contents.
+	 */
+	char const *pattern;
+	struct pattern_trie_node const *nodes;
+};
+
+/* Tries sorted by the beginnings of the extended pattern contents.
+ */
+struct pattern_tries {
+	size_t len;
+	struct pattern_trie const *ptr;
+};
+
+static struct pattern_trie const *
+find_pattern_trie(
+	struct pattern_tries const *const tries,
+	char const *const pattern
+	) {
+	if (!tries)
+		return NULL;
+	size_t lo = 0u;
+	size_t hi = tries->len;
+	while (lo < hi) {
+		size_t const mid = lo + (hi - lo) / 2u;
+		if (tries->ptr[mid].pattern == pattern)
+			return &tries->ptr[mid];
+		if (tries->ptr[mid].pattern < pattern)
+			lo = mid + 1u;
+		else
+			hi = mid;
+	}
+	return NULL;
+}
+
+/* Find the first alternative (in the pattern order) which matches the tokens
+ * from the beginning to an end between tokens_end_min and tokens_end_max
+ * followed by next_character_byte (unless NULL).
+ * Returns the end of the match or NULL.
+ *
+ * The tokens are walked once regardless of the number of the alternatives.
+ */
+static char const *
+pattern_trie_match(
+	struct pattern_trie const *const trie,
+	char const *const tokens,
+	char const *const tokens_end_min,
+	char const *const tokens_end_max,
+	char const *const next_character_byte
+	) {
+	assert(tokens <= tokens_end_min && tokens_end_min <= tokens_end_max);
+	char const *match = NULL;
+	unsigned alternative = UINT_MAX;
+	struct pattern_trie_node const *node = trie->nodes;
+	for (char const *p = tokens;; ++p) {
+		if (
+			node->alternative < alternative &&
+			p >= tokens_end_min && (
+				!next_character_byte ||
+				*p == *next_character_byte
+				)
+			) {
+			alternative = node->alternative;
+			match = p;
+		}
+		if (p >= tokens_end_max)
+			break;
+		unsigned child = node->first_child;
+		while (child && trie->nodes[child].character_byte != *p)
+			child = trie->nodes[child].next_sibling;
+		if (!child)
+			break;
+		node = &trie->nodes[child];
+	}
+	return match;
+}
+
+#endif  /* PATTERN_TRIE_H */
@@ -0,0 +1,241 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERN_TRIE_COMPILE_H
+#define PATTERN_TRIE_COMPILE_H
+
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pattern.h"
+#include "pattern_trie.h"
+
+/* Check if the extended pattern contents consist of two or more alternatives
+ * of plain character bytes only.
+ */
+static bool
+is_pattern_literal_list(char const *pattern, char const *const pattern_end) {
+	size_t alternatives = 1u;
+	while (pattern < pattern_end) {
+		char character_byte;
+		struct character_byte_class_info character_byte_class;
+		struct extended_pattern_info extended_pattern;
+		struct wildcard_pattern_info wildcard_pattern;
+		bool const measure_extended_patterns_off = false;
+		if (*pattern == '|') {
+			++alternatives;
+			++pattern;
+			continue;
+		}
+		if (parse_next_pattern_entity(
+			&pattern,
+			pattern_end,
+			NULL,
+			NULL,
+			&character_byte,
+			&character_byte_class,
+			&extended_pattern,
+			&wildcard_pattern,
+			measure_extended_patterns_off
+			) != CHARACTER_BYTE_PATTERN)
+			return false;
+	}
+	return alternatives > 1u;
+}
+
+/* Build a trie of the alternatives in the extended pattern contents
+ * (see is_pattern_literal_list).
+ * There must be room for (pattern_end - pattern + 1) nodes.
+ * Returns the number of the used nodes.
+ */
+static size_t
+build_pattern_trie(
+	char const *pattern,
+	char const *const pattern_end,
+	struct pattern_trie_node *const nodes
+	) {
+	static struct pattern_trie_node const empty_node = {
+		0u,
+		0u,
+		UINT_MAX,
+		'\0'
+	};
+	unsigned n = 1u;
+	unsigned alternative = 0u;
+	unsigned node = 0u;
+	nodes[0] = empty_node;
+	for (;;) {
+		char character_byte;
+		struct character_byte_class_info character_byte_class;
+		struct extended_pattern_info extended_pattern;
+		struct wildcard_pattern_info wildcard_pattern;
+		bool const measure_extended_patterns_off = false;
+		if (pattern >= pattern_end || *pattern == '|') {
+			if (nodes[node].alternative == UINT_MAX)
+				nodes[node].alternative = alternative;
+			if (pattern >= pattern_end)
+				return n;
+			++alternative;
+			++pattern;
+			node = 0u;
+			continue;
+		}
+		parse_next_pattern_entity(
+			&pattern,
+			pattern_end,
+			NULL,
+			NULL,
+			&character_byte,
+			&character_byte_class,
+			&extended_pattern,
+			&wildcard_pattern,
+			measure_extended_patterns_off
+			);
+		unsigned *child = &nodes[node].first_child;
+		while (*child && nodes[*child].character_byte != character_byte)
+			child = &nodes[*child].next_sibling;
+		if (!*child) {
+			nodes[n] = empty_node;
+			nodes[n].character_byte = character_byte;
+			*child = n++;
+		}
+		node = *child;
+	}
+}
+
+/* Find the extended patterns with plain character byte alternatives in
+ * a pattern and either count them and an upper bound for their trie nodes
+ * (if tries is NULL) or build their tries.
+ */
+static void
+compile_pattern_tries_in(
+	char const *pattern,
+	char const *const pattern_end,
+	struct pattern_trie *const tries,
+	struct pattern_trie_node *const nodes,
+	size_t *const trie_count,
+	size_t *const node_count
+	) {
+	while (pattern < pattern_end) {
+		char character_byte;
+		struct character_byte_class_info character_byte_class;
+		struct extended_pattern_info extended_pattern;
+		struct wildcard_pattern_info wildcard_pattern;
+		bool const measure_extended_patterns_off = false;
+		if (parse_next_pattern_entity(
+			&pattern,
+			pattern_end,
+			NULL,
+			NULL,
+			&character_byte,
+			&character_byte_class,
+			&extended_pattern,
+			&wildcard_pattern,
+			measure_extended_patterns_off
+			) != EXTENDED_PATTERN)
+			continue;
+		size_t const len = (size_t)(
+			extended_pattern.end - extended_pattern.begin
+			);
+		if (is_pattern_literal_list(
+			extended_pattern.begin,
+			extended_pattern.end
+			) && len < UINT_MAX) {
+			if (tries) {
+				tries[*trie_count].pattern =
+					extended_pattern.begin;
+				tries[*trie_count].nodes = nodes + *node_count;
+				*node_count += build_pattern_trie(
+					extended_pattern.begin,
+					extended_pattern.end,
+					nodes + *node_count
+					);
+			}
+			else
+				*node_count += len + 1u;
+			++*trie_count;
+			continue;
+		}
+		/* Look for nested extended patterns.
+		 */
+		compile_pattern_tries_in(
+			extended_pattern.begin,
+			extended_pattern.end,
+			tries,
+			nodes,
+			trie_count,
+			node_count
+			);
+	}
+}
+
+static int
+compare_pattern_tries(void const *const a, void const *const b) {
+	char const *const pattern_a = ((struct pattern_trie const *)a)->pattern;
+	char const *const pattern_b = ((struct pattern_trie const *)b)->pattern;
+	return pattern_a < pattern_b ? -1 : pattern_a > pattern_b;
+}
+
+/* Compile the extended patterns with plain character byte alternatives in
+ * the patterns to tries (see pattern_trie_match).
+ * Returns the tries which must be freed with free or NULL if out of memory.
+ */
+static struct pattern_tries *
+compile_pattern_tries(int const n, char const *const *const patterns) {
+	size_t trie_count = 0u;
+	size_t node_count = 0u;
+	for (int i = 0; i < n; ++i)
+		compile_pattern_tries_in(
+			patterns[i],
+			patterns[i] + strlen(patterns[i]),
+			NULL,
+			NULL,
+			&trie_count,
+			&node_count
+			);
+	struct pattern_tries *const result = malloc(
+		sizeof *result +
+		trie_count * sizeof (struct pattern_trie) +
+		node_count * sizeof (struct pattern_trie_node)
+		);
+	if (!result)
+		return NULL;
+	struct pattern_trie *const tries = (struct pattern_trie *)(result + 1);
+	struct pattern_trie_node *const nodes =
+		(struct pattern_trie_node *)(tries + trie_count);
+	trie_count = 0u;
+	node_count = 0u;
+	for (int i = 0; i < n; ++i)
+		compile_pattern_tries_in(
+			patterns[i],
+			patterns[i] + strlen(patterns[i]),
+			tries,
+			nodes,
+			&trie_count,
+			&node_count
+			);
+	qsort(tries, trie_count, sizeof *tries, compare_pattern_tries);
+	result->len = trie_count;
+	result->ptr = tries;
+	return result;
+}
+
+#endif  /* PATTERN_TRIE_COMPILE_H */
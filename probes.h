@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROBES_H
+#define PROBES_H
+
+/* USDT static tracepoints of the pam_ssh_auth_info provider.
+ *
+ * The probes are compiled in only if ENABLE_USDT is defined (see
+ * the --enable-usdt configure option).
+ * An enabled probe is a single no-op instruction until a tracer (such as
+ * bpftrace or perf) attaches to it and a disabled probe is nothing at all.
+ * The probe arguments are not evaluated if the probes are disabled so they
+ * must not have side effects.
+ *
+ * The probes:
+ *
+ *  authenticate__entry(pamh, argc, argv)
+ *      pam_sm_authenticate is called.
+ *  authenticate__return(pamh, ret)
+ *      pam_sm_authenticate returns.
+ *  pattern__line(index, pattern, line, line_len, matches)
+ *      A SSH authentication information line is evaluated against
+ *      the pattern argument index.
+ *  tokens_match__call(recursion_limit)
+ *      tokens_match_partially is entered with the remaining recursion limit
+ *      (the recursion depth is the recursion_limit option minus
+ *      the remaining recursion limit), that is a pattern match is started
+ *      or a rest of a pattern is tried after an extended pattern or
+ *      a wildcard pattern.
+ *  tokens_match__recursion_limit(pattern)
+ *      The recursion limit is exhausted at the rest of the pattern.
+ */
+
+#ifdef ENABLE_USDT
+#	include <sys/sdt.h>
+#	define PROBE1(name, a) \
+		DTRACE_PROBE1(pam_ssh_auth_info, name, a)
+#	define PROBE2(name, a, b) \
+		DTRACE_PROBE2(pam_ssh_auth_info, name, a, b)
+#	define PROBE3(name, a, b, c) \
+		DTRACE_PROBE3(pam_ssh_auth_info, name, a, b, c)
+#	define PROBE5(name, a, b, c, d, e) \
+		DTRACE_PROBE5(pam_ssh_auth_info, name, a, b, c, d, e)
+#else
+#	define PROBE1(name, a) ((void)0)
+#	define PROBE2(name, a, b) ((void)0)
+#	define PROBE3(name, a, b, c) ((void)0)
+#	define PROBE5(name, a, b, c, d, e) ((void)0)
+#endif
+
+#endif  /* PROBES_H */
@@ -0,0 +1,150 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGULAR_EXPRESSION_MATCH_H
+#define REGULAR_EXPRESSION_MATCH_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+
+/* A compiled regular expression and the data for matching it.
+ */
+struct regular_expression {
+	pcre2_code *code;
+	pcre2_match_data *match_data;
+	pcre2_match_context *match_context;
+};
+
+/* Get the message of a PCRE2 error code.
+ */
+static void
+get_regular_expression_error_message(
+	int const error_code,
+	char *const message,
+	size_t const message_size
+	) {
+	if (pcre2_get_error_message(
+		error_code,
+		(PCRE2_UCHAR *)message,
+		message_size
+		) < 0)
+		snprintf(message, message_size, "error %d", error_code);
+}
+
+static void
+destroy_regular_expression(struct regular_expression *const re) {
+	if (!re)
+		return;
+	pcre2_match_context_free(re->match_context);
+	pcre2_match_data_free(re->match_data);
+	pcre2_code_free(re->code);
+	free(re);
+}
+
+/* Compile a regular expression.
+ * If anchored, the regular expression must match a whole line (as if
+ * enclosed in ^(?: and )$) and otherwise (a part of) a line.
+ * The regular expression is compiled to machine code if the JIT compiler is
+ * available and otherwise it is interpreted.
+ * Returns the regular expression which must be destroyed with
+ * destroy_regular_expression or NULL on error (with an error message in
+ * the error buffer).
+ */
+static struct regular_expression *
+compile_regular_expression(
+	char const *const pattern,
+	bool const anchored,
+	char *const error,
+	size_t const error_size
+	) {
+	int error_code = PCRE2_ERROR_NOMEMORY;
+	PCRE2_SIZE error_offset = 0u;
+	struct regular_expression *const re = calloc(1u, sizeof *re);
+	if (
+		!re ||
+		!(re->code = pcre2_compile(
+			(PCRE2_SPTR)pattern,
+			PCRE2_ZERO_TERMINATED,
+			anchored ? PCRE2_ANCHORED | PCRE2_ENDANCHORED : 0u,
+			&error_code,
+			&error_offset,
+			NULL
+			)) ||
+		!(re->match_data = pcre2_match_data_create(1u, NULL)) ||
+		!(re->match_context = pcre2_match_context_create(NULL))
+		) {
+		get_regular_expression_error_message(
+			error_code,
+			error,
+			error_size
+			);
+		if (re && !re->code) {
+			size_t const len = strlen(error);
+			snprintf(
+				error + len,
+				error_size - len,
+				" at offset %zu",
+				(size_t)error_offset
+				);
+		}
+		destroy_regular_expression(re);
+		return NULL;
+	}
+	/* Without the JIT compiler, the regular expression is interpreted.
+	 */
+	(void)pcre2_jit_compile(re->code, PCRE2_JIT_COMPLETE);
+	return re;
+}
+
+/* Check if a regular expression matches the line (or a part of it unless
+ * anchored).
+ * The line need not be terminated.
+ * Returns 1 if the regular expression matches, 0 if it does not and
+ * a negative PCRE2 error code on error (such as PCRE2_ERROR_MATCHLIMIT if
+ * the match limit is exceeded).
+ */
+static int
+regular_expression_line_match(
+	struct regular_expression *const re,
+	char const *const line,
+	char const *const line_end,
+	unsigned const match_limit
+	) {
+	pcre2_set_match_limit(re->match_context, match_limit);
+	int const rc = pcre2_match(
+		re->code,
+		(PCRE2_SPTR)line,
+		(PCRE2_SIZE)(line_end - line),
+		0u,
+		0u,
+		re->match_data,
+		re->match_context
+		);
+	if (rc >= 0)
+		return 1;
+	if (rc == PCRE2_ERROR_NOMATCH)
+		return 0;
+	return rc;
+}
+
+#endif  /* REGULAR_EXPRESSION_MATCH_H */
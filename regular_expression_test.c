@@ -0,0 +1,102 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "regular_expression_match.h"
+
+static struct {
+	char const *pattern;
+	bool anchored;
+	char const *lines;
+	unsigned match_limit;
+	int expected;
+} const test_data[] = {
+	/* Only the first line is matched.
+	 */
+	{"^publickey ssh-ed25519 ", false, "publickey ssh-ed25519 AAAA\npassword", 100u, 1},
+	{"AAAA$", false, "publickey ssh-ed25519 AAAA\npassword", 100u, 1},
+	{"password", false, "publickey ssh-ed25519 AAAA\npassword", 100u, 0},
+	{"^$", false, "\npassword", 100u, 1},
+	/* Anchored regular expressions match whole lines only.
+	 */
+	{"publickey ssh-ed25519 ", true, "publickey ssh-ed25519 AAAA\npassword", 100u, 0},
+	{"AAAA", true, "publickey ssh-ed25519 AAAA\npassword", 100u, 0},
+	{"publickey ssh-ed25519 \\S+", true, "publickey ssh-ed25519 AAAA\npassword", 100u, 1},
+	{"password|publickey .*", true, "publickey ssh-ed25519 AAAA\npassword", 100u, 1},
+	{"password|publickey", true, "publickey ssh-ed25519 AAAA\npassword", 100u, 0},
+	{"", true, "\npassword", 100u, 1},
+	/* Character set constraints with exact repetition counts.
+	 */
+	{"^publickey ssh-ed25519 [A-Za-z0-9+/]{4}$", false, "publickey ssh-ed25519 AAAA\n", 100u, 1},
+	{"^publickey ssh-ed25519 [A-Za-z0-9+/]{4}$", false, "publickey ssh-ed25519 AAAAA\n", 100u, 0},
+	{"^publickey ssh-ed25519 [A-Za-z0-9+/]{4}$", false, "publickey ssh-ed25519 AA-A\n", 100u, 0},
+	{"publickey ssh-ed25519 [A-Za-z0-9+/]{4}", true, "publickey ssh-ed25519 AAAAA\n", 100u, 0},
+	/* Exponential backtracking is bounded by the match limit.
+	 */
+	{"^(a+)+$", false, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab", 10000u, PCRE2_ERROR_MATCHLIMIT},
+	{"^(a+)+$", false, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", 10000u, 1},
+	{NULL, false, NULL, 0u, 0}
+};
+
+int
+main() {
+	char error[256];
+	/* Invalid regular expressions are reported.
+	 */
+	assert(!compile_regular_expression("(", true, error, sizeof error));
+	fprintf(stderr, "compile_regular_expression(\"(\"): %s\n", error);
+	for (int i = 0; test_data[i].pattern; ++i) {
+		struct regular_expression *const re =
+			compile_regular_expression(
+				test_data[i].pattern,
+				test_data[i].anchored,
+				error,
+				sizeof error
+				);
+		assert(re);
+		char const *const lines = test_data[i].lines;
+		int const actual = regular_expression_line_match(
+			re,
+			lines,
+			lines + strcspn(lines, "\n"),
+			test_data[i].match_limit
+			);
+		fprintf(
+			stderr,
+			"regular_expression_line_match(\"%s\"%s, \"%.*s\", %u)"
+			" %s %d\n",
+			test_data[i].pattern,
+			test_data[i].anchored ? " (anchored)" : "",
+			(int)strcspn(lines, "\n"),
+			lines,
+			test_data[i].match_limit,
+			actual == test_data[i].expected ? "==" : "!=",
+			test_data[i].expected
+			);
+		destroy_regular_expression(re);
+		if (actual != test_data[i].expected)
+			return 1;
+	}
+	fprintf(stderr, "OK\n");
+	return 0;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include "config.h"
+#endif
+
+#undef  NDEBUG
+#define NDEBUG
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pam_options.h"
+#include "pattern_set_match.h"
+#include "ssh_auth_info_match.h"
+
+/* The matching statistics and trace (TOKENS_MATCH_STATS and
+ * TOKENS_MATCH_TRACE) are not collected because they are global.
+ */
+struct ssh_auth_info_match {
+	struct pattern_set set;
+};
+
+static void
+set_error(char *const error, size_t const error_size, char const *message) {
+	if (error && error_size)
+		snprintf(error, error_size, "%s", message);
+}
+
+struct ssh_auth_info_match *
+ssh_auth_info_match_compile(
+	int argc,
+	char const *const *argv,
+	char *const error,
+	size_t const error_size
+	) {
+	struct pam_options options;
+	int const n = parse_pam_options(&options, argc, argv);
+	argc -= n;
+	argv += n;
+	if (options.invalid) {
+		if (error && error_size)
+			snprintf(
+				error,
+				error_size,
+				"invalid option \"%s\"",
+				options.invalid
+				);
+		errno = EINVAL;
+		return NULL;
+	}
+	struct ssh_auth_info_match *const match = calloc(1u, sizeof *match);
+	if (!match) {
+		set_error(error, error_size, "out of memory");
+		errno = ENOMEM;
+		return NULL;
+	}
+	char message[1024];
+	int const error_number = pattern_set_init(
+		&match->set,
+		&options,
+		argc,
+		argv,
+		message,
+		sizeof message
+		);
+	if (error_number) {
+		ssh_auth_info_match_free(match);
+		set_error(error, error_size, message);
+		errno = error_number;
+		return NULL;
+	}
+	return match;
+}
+
+int
+ssh_auth_info_match_line(
+	struct ssh_auth_info_match const *const match,
+	char const *const line,
+	size_t const len
+	) {
+	struct pattern_set_scratch scratch;
+	if (!pattern_set_scratch_init(&match->set, &scratch))
+		return -2;
+	int match_index = -1;
+	for (int i = 0; i < match->set.n_patterns; ++i) {
+		if (pattern_set_match_line(
+			&match->set,
+			&scratch,
+			(size_t)i,
+			line,
+			line + len
+			) > 0) {
+			match_index = i;
+			break;
+		}
+	}
+	pattern_set_scratch_destroy(&scratch);
+	return match_index;
+}
+
+enum ssh_auth_info_match_result
+ssh_auth_info_match_auth_info(
+	struct ssh_auth_info_match const *const match,
+	char const *const ssh_auth_info,
+	size_t const len
+	) {
+	if (!ssh_auth_info || !len)
+		return SSH_AUTH_INFO_MATCH_IGNORE;
+	char const *const end = ssh_auth_info + len;
+	struct pattern_set_scratch scratch;
+	struct match_matrix matrix;
+	matrix.rows = NULL;
+	if (
+		!pattern_set_scratch_init(&match->set, &scratch) ||
+		!match_matrix_init(
+			&matrix,
+			(size_t)match->set.n_patterns,
+			count_ssh_auth_info_lines(ssh_auth_info, end)
+			)
+		) {
+		match_matrix_destroy(&matrix);
+		pattern_set_scratch_destroy(&scratch);
+		return SSH_AUTH_INFO_MATCH_ERROR;
+	}
+	int decisive_index;
+	bool const success = pattern_set_evaluate(
+		&match->set,
+		&scratch,
+		NULL,
+		&matrix,
+		ssh_auth_info,
+		end,
+		false,
+		false,
+		&decisive_index
+		);
+	match_matrix_destroy(&matrix);
+	pattern_set_scratch_destroy(&scratch);
+	return success
+		? SSH_AUTH_INFO_MATCH_SUCCESS
+		: SSH_AUTH_INFO_MATCH_FAILURE;
+}
+
+void
+ssh_auth_info_match_free(struct ssh_auth_info_match *const match) {
+	if (!match)
+		return;
+	pattern_set_destroy(&match->set);
+	free(match);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SSH_AUTH_INFO_MATCH_H
+#define SSH_AUTH_INFO_MATCH_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The pattern matching engine of pam_ssh_auth_info (see
+ * pam_ssh_auth_info(8) for the pattern syntax and the module arguments).
+ *
+ * A compiled handle is immutable so it can be used for matching
+ * concurrently by multiple threads.
+ */
+struct ssh_auth_info_match;
+
+/* The results of ssh_auth_info_match_auth_info (corresponding to
+ * the PAM_SUCCESS, PAM_AUTH_ERR and PAM_IGNORE return values of
+ * the module).
+ */
+enum ssh_auth_info_match_result {
+	SSH_AUTH_INFO_MATCH_ERROR = -1,
+	SSH_AUTH_INFO_MATCH_SUCCESS,
+	SSH_AUTH_INFO_MATCH_FAILURE,
+	SSH_AUTH_INFO_MATCH_IGNORE
+};
+
+/* Compile module arguments (options followed by patterns).
+ * The match style options (all_of, any_of, at_least, exactly and none_of)
+ * and the recursion_limit, re_match_limit, re_unanchored and reorder options
+ * are used and the other options are ignored.
+ * The arguments need not outlive the handle.
+ * Returns a handle which must be freed with ssh_auth_info_match_free or NULL
+ * on error (with errno set to EINVAL for an invalid option or pattern or to
+ * ENOMEM and with an error message in the error buffer unless NULL).
+ */
+struct ssh_auth_info_match *
+ssh_auth_info_match_compile(
+	int argc,
+	char const *const *argv,
+	char *error,
+	size_t error_size
+	);
+
+/* Match a SSH authentication information line (without a newline) against
+ * the patterns.
+ * Returns the index of the first pattern matching (a prefix of) the line,
+ * -1 if no pattern matches or -2 if out of memory.
+ */
+int
+ssh_auth_info_match_line(
+	struct ssh_auth_info_match const *match,
+	char const *line,
+	size_t len
+	);
+
+/* Match SSH authentication information (the value of the SSH_AUTH_INFO_0
+ * environment variable, that is lines separated by newlines) like
+ * the module does.
+ * Empty SSH authentication information is ignored.
+ */
+enum ssh_auth_info_match_result
+ssh_auth_info_match_auth_info(
+	struct ssh_auth_info_match const *match,
+	char const *ssh_auth_info,
+	size_t len
+	);
+
+/* Free a handle.
+ */
+void
+ssh_auth_info_match_free(struct ssh_auth_info_match *match);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* SSH_AUTH_INFO_MATCH_H */
@@ -0,0 +1,242 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#undef NDEBUG
+
+#ifdef HAVE_CONFIG_H
+#	include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <pthread.h>
+
+#include "ssh_auth_info_match.h"
+
+#define N_THREADS 4
+#define N_ITERATIONS 1000
+
+#define ED25519_LINE "publickey ssh-ed25519 AAAAC3NzaC1lZDI1NTE5"
+#define SK_LINE "publickey sk-ssh-ed25519@openssh.com AAAAGnNr"
+
+struct ssh_auth_info_match_test_data {
+	char const *argv[4];
+	char const *ssh_auth_info;
+	enum ssh_auth_info_match_result expected;
+};
+
+static struct ssh_auth_info_match_test_data const test_data[] = {
+	{{"publickey", NULL}, "", SSH_AUTH_INFO_MATCH_IGNORE},
+	{{"publickey", NULL}, ED25519_LINE, SSH_AUTH_INFO_MATCH_SUCCESS},
+	{{"publickey", NULL}, "password\n", SSH_AUTH_INFO_MATCH_FAILURE},
+	{
+		{"publickey=ssh-ed25519=*", "password", NULL},
+		ED25519_LINE "\npassword\n",
+		SSH_AUTH_INFO_MATCH_SUCCESS
+	},
+	{
+		{"publickey=ssh-ed25519=*", "password", NULL},
+		ED25519_LINE "\n",
+		SSH_AUTH_INFO_MATCH_FAILURE
+	},
+	{
+		{"any_of", "publickey=*sk-*@openssh.com", "password", NULL},
+		"password",
+		SSH_AUTH_INFO_MATCH_SUCCESS
+	},
+	{
+		{"any_of", "publickey=*sk-*@openssh.com", NULL},
+		ED25519_LINE,
+		SSH_AUTH_INFO_MATCH_FAILURE
+	},
+	{
+		{"none_of", "password", NULL},
+		SK_LINE "\npassword",
+		SSH_AUTH_INFO_MATCH_FAILURE
+	},
+	{{"none_of", "password", NULL}, SK_LINE, SSH_AUTH_INFO_MATCH_SUCCESS},
+	{
+		{"at_least=2", "publickey", NULL},
+		ED25519_LINE "\n" SK_LINE,
+		SSH_AUTH_INFO_MATCH_SUCCESS
+	},
+	{
+		{"at_least=2", "publickey", NULL},
+		ED25519_LINE "\npassword",
+		SSH_AUTH_INFO_MATCH_FAILURE
+	},
+	{
+		{"exactly=1", "publickey", NULL},
+		ED25519_LINE "\n" SK_LINE,
+		SSH_AUTH_INFO_MATCH_FAILURE
+	},
+	{
+		{"exactly=0", "publickey", NULL},
+		"password",
+		SSH_AUTH_INFO_MATCH_SUCCESS
+	},
+#ifdef HAVE_PCRE2
+	/* Regular expressions match whole lines unless unanchored.
+	 */
+	{
+		{"re:keyboard-interactive", NULL},
+		"keyboard-interactive/pam",
+		SSH_AUTH_INFO_MATCH_FAILURE
+	},
+	{
+		{"re_unanchored", "re:keyboard-interactive", NULL},
+		"keyboard-interactive/pam",
+		SSH_AUTH_INFO_MATCH_SUCCESS
+	},
+#endif
+	{{NULL}, NULL, SSH_AUTH_INFO_MATCH_ERROR}
+};
+
+static int
+count_args(char const *const *const argv) {
+	int argc = 0;
+	while (argv[argc])
+		++argc;
+	return argc;
+}
+
+/* Match concurrently using a shared handle.
+ */
+static void *
+match_concurrently(void *const arg) {
+	struct ssh_auth_info_match const *const match = arg;
+	static char const ssh_auth_info[] = SK_LINE "\npassword\n" ED25519_LINE;
+	for (int i = 0; i < N_ITERATIONS; ++i) {
+		assert(ssh_auth_info_match_auth_info(
+			match,
+			ssh_auth_info,
+			sizeof ssh_auth_info - 1u
+			) == SSH_AUTH_INFO_MATCH_SUCCESS);
+		assert(ssh_auth_info_match_line(
+			match,
+			"password",
+			8u
+			) == -1);
+		assert(ssh_auth_info_match_line(
+			match,
+			ED25519_LINE,
+			sizeof ED25519_LINE - 1u
+			) == 1);
+	}
+	return NULL;
+}
+
+int
+main() {
+	char error[256];
+	for (int i = 0; test_data[i].ssh_auth_info; ++i) {
+		struct ssh_auth_info_match_test_data const *const data =
+			&test_data[i];
+		struct ssh_auth_info_match *const match =
+			ssh_auth_info_match_compile(
+				count_args(data->argv),
+				data->argv,
+				error,
+				sizeof error
+				);
+		assert(match);
+		enum ssh_auth_info_match_result const actual =
+			ssh_auth_info_match_auth_info(
+				match,
+				data->ssh_auth_info,
+				strlen(data->ssh_auth_info)
+				);
+		fprintf(
+			stderr,
+			"%s ... \"%s\": %d\n",
+			data->argv[0],
+			data->ssh_auth_info,
+			(int)actual
+			);
+		assert(actual == data->expected);
+		ssh_auth_info_match_free(match);
+	}
+	/* The line need not be terminated.
+	 */
+	char const *const argv[] = {
+		"any_of",
+		"publickey=ssh-rsa=*",
+		"publickey=@(ssh-ed25519|sk-ssh-ed25519@openssh.com)=*",
+#ifdef HAVE_PCRE2
+		"re:keyboard-interactive/\\w+",
+#endif
+		NULL
+	};
+	struct ssh_auth_info_match *const match = ssh_auth_info_match_compile(
+		count_args(argv),
+		argv,
+		error,
+		sizeof error
+		);
+	assert(match);
+	assert(ssh_auth_info_match_line(match, ED25519_LINE, 9u) == -1);
+	assert(ssh_auth_info_match_line(match, SK_LINE, 36u) == -1);
+	assert(ssh_auth_info_match_line(match, SK_LINE, 37u) == 1);
+#ifdef HAVE_PCRE2
+	assert(ssh_auth_info_match_line(
+		match,
+		"keyboard-interactive/pam",
+		24u
+		) == 2);
+#endif
+	pthread_t threads[N_THREADS];
+	for (int i = 0; i < N_THREADS; ++i)
+		assert(pthread_create(
+			&threads[i],
+			NULL,
+			match_concurrently,
+			match
+			) == 0);
+	for (int i = 0; i < N_THREADS; ++i)
+		assert(pthread_join(threads[i], NULL) == 0);
+	ssh_auth_info_match_free(match);
+	/* Invalid patterns.
+	 */
+	char const *const invalid_argv[] = {"publickey", "re:(", NULL};
+	errno = 0;
+	assert(!ssh_auth_info_match_compile(
+		2,
+		invalid_argv,
+		error,
+		sizeof error
+		));
+	fprintf(stderr, "%s\n", error);
+	assert(errno == EINVAL);
+	assert(strstr(error, "re:("));
+	/* Invalid options.
+	 */
+	char const *const invalid_options_argv[] = {"at_least=", "publickey"};
+	errno = 0;
+	assert(!ssh_auth_info_match_compile(
+		2,
+		invalid_options_argv,
+		error,
+		sizeof error
+		));
+	fprintf(stderr, "%s\n", error);
+	assert(errno == EINVAL);
+	assert(strstr(error, "at_least="));
+	return 0;
+}
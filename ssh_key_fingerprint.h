@@ -0,0 +1,248 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SSH_KEY_FINGERPRINT_H
+#define SSH_KEY_FINGERPRINT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* The minimum length of a base64 encoded key blob token.
+ */
+#define SSH_KEY_BLOB_LEN_MIN 40u
+
+/* The size of a SHA256 fingerprint (SHA256:...) including the NUL byte.
+ */
+#define SSH_KEY_FINGERPRINT_SIZE 51u
+
+static char const ssh_key_base64_alphabet[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+struct sha256_context {
+	uint32_t state[8];
+	uint64_t len;
+	unsigned char block[64];
+};
+
+static uint32_t
+rotate_right_32(uint32_t const x, unsigned const n) {
+	return (x >> n) | (x << (32u - n));
+}
+
+static void
+sha256_transform(
+	struct sha256_context *const context,
+	unsigned char const *const block
+	) {
+	static uint32_t const k[64] = {
+		0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u,
+		0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
+		0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u,
+		0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
+		0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu,
+		0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+		0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u,
+		0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
+		0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u,
+		0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
+		0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u,
+		0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+		0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u,
+		0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+		0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u,
+		0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u
+	};
+	uint32_t w[64];
+	for (unsigned i = 0u; i < 16u; ++i)
+		w[i] =
+			(uint32_t)block[4u * i] << 24 |
+			(uint32_t)block[4u * i + 1u] << 16 |
+			(uint32_t)block[4u * i + 2u] << 8 |
+			(uint32_t)block[4u * i + 3u];
+	for (unsigned i = 16u; i < 64u; ++i) {
+		uint32_t const s0 =
+			rotate_right_32(w[i - 15u], 7u) ^
+			rotate_right_32(w[i - 15u], 18u) ^
+			w[i - 15u] >> 3;
+		uint32_t const s1 =
+			rotate_right_32(w[i - 2u], 17u) ^
+			rotate_right_32(w[i - 2u], 19u) ^
+			w[i - 2u] >> 10;
+		w[i] = w[i - 16u] + s0 + w[i - 7u] + s1;
+	}
+	uint32_t s[8];
+	memcpy(s, context->state, sizeof s);
+	for (unsigned i = 0u; i < 64u; ++i) {
+		uint32_t const t1 = s[7] +
+			(rotate_right_32(s[4], 6u) ^
+			rotate_right_32(s[4], 11u) ^
+			rotate_right_32(s[4], 25u)) +
+			((s[4] & s[5]) ^ (~s[4] & s[6])) +
+			k[i] +
+			w[i];
+		uint32_t const t2 =
+			(rotate_right_32(s[0], 2u) ^
+			rotate_right_32(s[0], 13u) ^
+			rotate_right_32(s[0], 22u)) +
+			((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+		memmove(s + 1, s, 7u * sizeof *s);
+		s[4] += t1;
+		s[0] = t1 + t2;
+	}
+	for (unsigned i = 0u; i < 8u; ++i)
+		context->state[i] += s[i];
+}
+
+static void
+sha256_init(struct sha256_context *const context) {
+	static uint32_t const state[8] = {
+		0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au,
+		0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u
+	};
+	memcpy(context->state, state, sizeof state);
+	context->len = 0u;
+}
+
+static void
+sha256_update(
+	struct sha256_context *const context,
+	unsigned char const *data,
+	size_t len
+	) {
+	for (; len > 0u; ++data, --len) {
+		context->block[context->len++ % 64u] = *data;
+		if (context->len % 64u == 0u)
+			sha256_transform(context, context->block);
+	}
+}
+
+static void
+sha256_final(
+	struct sha256_context *const context,
+	unsigned char digest[32]
+	) {
+	uint64_t const bits = context->len * 8u;
+	unsigned char pad[72] = {0x80u};
+	size_t const pad_len = 64u - (context->len + 8u) % 64u;
+	for (unsigned i = 0u; i < 8u; ++i)
+		pad[pad_len + i] = (unsigned char)(bits >> (56u - 8u * i));
+	sha256_update(context, pad, pad_len + 8u);
+	for (unsigned i = 0u; i < 32u; ++i)
+		digest[i] = (unsigned char)(context->state[i / 4u] >> (
+			24u - 8u * (i % 4u)
+			));
+}
+
+/* Format the SHA256 fingerprint (like ssh-keygen -l) of a base64 encoded key
+ * blob.
+ * Returns false (and leaves the fingerprint untouched) if the blob is too
+ * short or not base64 encoded.
+ */
+static bool
+format_ssh_key_fingerprint(
+	char const *blob,
+	char const *const blob_end,
+	char fingerprint[SSH_KEY_FINGERPRINT_SIZE]
+	) {
+	if ((size_t)(blob_end - blob) < SSH_KEY_BLOB_LEN_MIN)
+		return false;
+	struct sha256_context context;
+	sha256_init(&context);
+	uint32_t bits = 0u;
+	unsigned n_bits = 0u;
+	for (; blob < blob_end && *blob != '='; ++blob) {
+		char const *const p = *blob ? strchr(
+			ssh_key_base64_alphabet,
+			*blob
+			) : NULL;
+		if (!p)
+			return false;
+		bits = bits << 6 | (uint32_t)(p - ssh_key_base64_alphabet);
+		n_bits += 6u;
+		if (n_bits >= 8u) {
+			n_bits -= 8u;
+			unsigned char const byte =
+				(unsigned char)(bits >> n_bits);
+			sha256_update(&context, &byte, 1u);
+		}
+	}
+	for (; blob < blob_end; ++blob) {
+		if (*blob != '=')
+			return false;
+	}
+	unsigned char digest[33] = {0};
+	sha256_final(&context, digest);
+	memcpy(fingerprint, "SHA256:", 7u);
+	char *out = fingerprint + 7;
+	for (unsigned i = 0u; i < 32u; i += 3u) {
+		uint32_t const triple =
+			(uint32_t)digest[i] << 16 |
+			(uint32_t)digest[i + 1u] << 8 |
+			(uint32_t)(i + 2u < 32u ? digest[i + 2u] : 0u);
+		for (unsigned j = 0u; j < 4u && i * 4u / 3u + j < 43u; ++j)
+			*out++ = ssh_key_base64_alphabet[
+				triple >> (18u - 6u * j) & 0x3fu
+				];
+	}
+	*out = '\0';
+	return true;
+}
+
+/* Copy a SSH authentication information line replacing base64 encoded key
+ * blobs with their SHA256 fingerprints.
+ * The copy is truncated to the size (including the NUL byte).
+ * Returns the length of the copy.
+ */
+static size_t
+abbreviate_ssh_auth_info_line(
+	char const *line,
+	char const *const line_end,
+	char *const out,
+	size_t const size
+	) {
+	size_t len = 0u;
+	if (size == 0u)
+		return len;
+	while (line < line_end && len + 1u < size) {
+		char const *const space = memchr(
+			line,
+			' ',
+			(size_t)(line_end - line)
+			);
+		char const *const token_end = space ? space : line_end;
+		char fingerprint[SSH_KEY_FINGERPRINT_SIZE];
+		char const *token = line;
+		size_t n = (size_t)(token_end - line);
+		if (format_ssh_key_fingerprint(line, token_end, fingerprint)) {
+			token = fingerprint;
+			n = strlen(fingerprint);
+		}
+		if (n > size - 1u - len)
+			n = size - 1u - len;
+		memcpy(out + len, token, n);
+		len += n;
+		if (space && len + 1u < size)
+			out[len++] = ' ';
+		line = space ? space + 1 : line_end;
+	}
+	out[len] = '\0';
+	return len;
+}
+
+#endif  /* SSH_KEY_FINGERPRINT_H */
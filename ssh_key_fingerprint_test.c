@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "ssh_key_fingerprint.h"
+
+#define ED25519_KEY \
+	"AAAAC3NzaC1lZDI1NTE5AAAAIFcUj3uRVCEk9OWUb1IbPOHxhEndD9ZEIxzOi7nTnuG6"
+#define ED25519_FINGERPRINT \
+	"SHA256:cEgpBWLBfsUtoOxw/erSilqq2JtOMT4QqmVccVNFmVs"
+#define RSA_KEY \
+	"AAAAB3NzaC1yc2EAAAADAQABAAAAgQDCWFcbV28eFS9dEUhHSvABD3OMDx67iPkUrVP0" \
+	"TTkwMMxEjD2XyPsPcV8yFnWVKnmK8a5Op3GVQHCZUjcRB9wrgl3me+o5d0x6Qpq1leyB" \
+	"GTaD0YPSNSg9cS4Y5xGgryaN8fB0jOkQr9a7gzq3S5ncfQruWz2Nkw/pvYyi/phKDw=="
+#define RSA_FINGERPRINT \
+	"SHA256:6i4B8AMTOT5+VEk2mVQPph69cw3I50418wMeaUkUkF0"
+
+struct ssh_key_fingerprint_test_data {
+	char const *line;
+	char const *expected;
+};
+
+static struct ssh_key_fingerprint_test_data const test_data[] = {
+	{"", ""},
+	{"password", "password"},
+	{"keyboard-interactive", "keyboard-interactive"},
+	{
+		"publickey ssh-ed25519 " ED25519_KEY,
+		"publickey ssh-ed25519 " ED25519_FINGERPRINT
+	},
+	{
+		"publickey ssh-rsa " RSA_KEY,
+		"publickey ssh-rsa " RSA_FINGERPRINT
+	},
+	{
+		"publickey ssh-rsa " RSA_KEY " trailing",
+		"publickey ssh-rsa " RSA_FINGERPRINT " trailing"
+	},
+	/* Not base64 encoded.
+	 */
+	{
+		"publickey ssh-ed25519 " ED25519_KEY "-",
+		"publickey ssh-ed25519 " ED25519_KEY "-"
+	},
+	{
+		"publickey ssh-ed25519 " ED25519_KEY "=A",
+		"publickey ssh-ed25519 " ED25519_KEY "=A"
+	},
+	{NULL, NULL}
+};
+
+static void
+print_digest(unsigned char const digest[32]) {
+	for (unsigned i = 0u; i < 32u; ++i)
+		fprintf(stderr, "%02x", digest[i]);
+	fprintf(stderr, "\n");
+}
+
+int
+main() {
+	/* SHA-256 of "abc" and of a message spanning two padded blocks.
+	 */
+	static unsigned char const abc_digest[32] = {
+		0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+		0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+		0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+		0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+	};
+	static unsigned char const abcdbcde_digest[32] = {
+		0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8,
+		0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+		0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
+		0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1
+	};
+	static char const abcdbcde[] =
+		"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+	struct sha256_context context;
+	unsigned char digest[32];
+	sha256_init(&context);
+	sha256_update(&context, (unsigned char const *)"abc", 3u);
+	sha256_final(&context, digest);
+	print_digest(digest);
+	assert(memcmp(digest, abc_digest, sizeof digest) == 0);
+	sha256_init(&context);
+	sha256_update(
+		&context,
+		(unsigned char const *)abcdbcde,
+		sizeof abcdbcde - 1u
+		);
+	sha256_final(&context, digest);
+	print_digest(digest);
+	assert(memcmp(digest, abcdbcde_digest, sizeof digest) == 0);
+	/* Fingerprints.
+	 */
+	char fingerprint[SSH_KEY_FINGERPRINT_SIZE];
+	assert(format_ssh_key_fingerprint(
+		ED25519_KEY,
+		ED25519_KEY + sizeof ED25519_KEY - 1u,
+		fingerprint
+		));
+	fprintf(stderr, "%s\n", fingerprint);
+	assert(strcmp(fingerprint, ED25519_FINGERPRINT) == 0);
+	assert(!format_ssh_key_fingerprint(
+		ED25519_KEY,
+		ED25519_KEY + SSH_KEY_BLOB_LEN_MIN - 1u,
+		fingerprint
+		));
+	/* Lines.
+	 */
+	for (int i = 0; test_data[i].line; ++i) {
+		char const *const line = test_data[i].line;
+		char const *const expected = test_data[i].expected;
+		char out[256];
+		size_t const len = abbreviate_ssh_auth_info_line(
+			line,
+			line + strlen(line),
+			out,
+			sizeof out
+			);
+		fprintf(stderr, "\"%s\" -> \"%s\"\n", line, out);
+		assert(len == strlen(expected));
+		assert(strcmp(out, expected) == 0);
+	}
+	/* Truncation.
+	 */
+	char const *const line = "publickey ssh-ed25519 " ED25519_KEY;
+	char out[16];
+	size_t const len = abbreviate_ssh_auth_info_line(
+		line,
+		line + strlen(line),
+		out,
+		sizeof out
+		);
+	assert(len == sizeof out - 1u);
+	assert(strcmp(out, "publickey ssh-e") == 0);
+	return 0;
+}
@@ -16,11 +16,22 @@
  * <http://www.gnu.org/licenses/>.
  */
 
+#ifndef TOKENS_MATCH_H
+#define TOKENS_MATCH_H
+
 #include <assert.h>
 #include <stdbool.h>
 #include <string.h>
 
+#ifdef __SSSE3__
+#	include <tmmintrin.h>
+#endif
+
 #include "pattern.h"
+#include "pattern_analysis.h"
+#include "pattern_bitset.h"
+#include "pattern_trie.h"
+#include "probes.h"
 
 struct tokens_match_config {
 	bool allow_prefix_match;
@@ -28,8 +39,125 @@ struct tokens_match_config {
 		struct character_byte_set pattern;
 		struct character_byte_set token;
 	} separators;
+	/* The compiled extended patterns (see compile_pattern_tries) or NULL.
+	 */
+	struct pattern_tries const *tries;
+	/* The analyzed patterns (see analyze_patterns) or NULL.
+	 * Without an analysis, possessive repetition extended patterns are
+	 * matched by backtracking like other extended patterns.
+	 */
+	struct pattern_analysis const *analysis;
+};
+
+#ifdef TOKENS_MATCH_STATS
+/* Matching statistics for benchmarks, step count tests and stats files.
+ * The statistics are collected only if TOKENS_MATCH_STATS is defined and
+ * they must be reset by the caller.
+ * Unlike time, they are deterministic.
+ */
+struct tokens_match_stats {
+	/* The number of the partial match calls.
+	 */
+	unsigned long calls;
+	/* The number of the parsed pattern entities.
+	 */
+	unsigned long entities;
+	/* The number of the compared token character bytes.
+	 */
+	unsigned long compared;
+	/* The number of the recursion limit exhaustions.
+	 */
+	unsigned long exhaustions;
+	/* The smallest remaining recursion limit.
+	 */
+	unsigned recursion_limit_min;
+};
+
+static struct tokens_match_stats tokens_match_stats;
+
+#	define TOKENS_MATCH_STATS_ADD(counter, n) \
+		(tokens_match_stats.counter += (unsigned long)(n))
+#else
+#	define TOKENS_MATCH_STATS_ADD(counter, n) ((void)0)
+#endif
+
+#ifdef TOKENS_MATCH_TRACE
+/* Matcher decision events for the trace option.
+ * The events are recorded only if TOKENS_MATCH_TRACE is defined and
+ * the caller has set the ring buffer (see struct tokens_match_trace).
+ */
+enum tokens_match_trace_kind {
+	/* A line evaluation (recorded by the caller).
+	 * The offsets are the pattern and line indexes.
+	 */
+	TOKENS_MATCH_TRACE_LINE,
+	/* A split point of an extended pattern.
+	 */
+	TOKENS_MATCH_TRACE_EXTENDED,
+	/* A split point of an asterisk (at the rest of the pattern).
+	 */
+	TOKENS_MATCH_TRACE_WILDCARD,
+	/* A recursion limit exhaustion.
+	 */
+	TOKENS_MATCH_TRACE_LIMIT
 };
 
+struct tokens_match_trace_event {
+	unsigned pattern_offset;
+	unsigned tokens_offset;
+	unsigned char kind;
+	bool result;
+};
+
+#	define TOKENS_MATCH_TRACE_SIZE 64u
+
+/* A ring buffer of the latest TOKENS_MATCH_TRACE_SIZE events.
+ * The offsets of the events are relative to the pattern and tokens bases
+ * which must be set by the caller.
+ */
+struct tokens_match_trace {
+	/* The ring buffer or NULL if tracing is off.
+	 */
+	struct tokens_match_trace_event *events;
+	char const *pattern_base;
+	char const *tokens_base;
+	/* The number of the recorded events (including the overwritten ones).
+	 */
+	unsigned long n;
+};
+
+static struct tokens_match_trace tokens_match_trace;
+
+static void
+tokens_match_trace_add(
+	enum tokens_match_trace_kind const kind,
+	unsigned const pattern_offset,
+	unsigned const tokens_offset,
+	bool const result
+	) {
+	struct tokens_match_trace_event *const event =
+		&tokens_match_trace.events[
+			tokens_match_trace.n++ % TOKENS_MATCH_TRACE_SIZE
+			];
+	event->pattern_offset = pattern_offset;
+	event->tokens_offset = tokens_offset;
+	event->kind = (unsigned char)kind;
+	event->result = result;
+}
+
+#	define TOKENS_MATCH_TRACE_ADD(kind, pattern, tokens, result) \
+		(tokens_match_trace.events ? tokens_match_trace_add( \
+			TOKENS_MATCH_TRACE_##kind, \
+			(unsigned)( \
+				(pattern) - tokens_match_trace.pattern_base \
+				), \
+			(unsigned)((tokens) - tokens_match_trace.tokens_base), \
+			(result) \
+			) : (void)0)
+#else
+#	define TOKENS_MATCH_TRACE_ADD(kind, pattern, tokens, result) ((void)0)
+#endif
+
 struct tokens_pattern {
 	char const *tokens;
 	char const *pattern;
@@ -147,6 +275,137 @@ character_byte_matches_character_byte_class(
 	}
 }
 
+/* Find the first character byte in a set one character byte at a time.
+ * Returns NULL if there is none.
+ */
+static char const *
+find_character_byte_in_bitset_scalar(
+	struct character_byte_bitset const *const set,
+	char const *p,
+	char const *const end
+	) {
+	assert(p <= end);
+	for (; p < end; ++p) {
+		if (character_byte_bitset_contains(set, *p))
+			return p;
+	}
+	return NULL;
+}
+
+/* Find the first character byte in a set.
+ * Returns NULL if there is none.
+ *
+ * With SSSE3, 16 character bytes are tested at a time by splitting them to
+ * nibbles and looking them up from the prepared nibble tables (see
+ * prepare_pattern_entity_bitset_columns).
+ */
+static char const *
+find_character_byte_in_bitset(
+	struct pattern_entity_bitset const *const bitset,
+	char const *p,
+	char const *const end
+	) {
+	assert(p <= end);
+#ifdef __SSSE3__
+	if (end - p >= 16) {
+		__m128i const columns_low = _mm_loadu_si128(
+			(__m128i const *)bitset->columns[0]
+			);
+		__m128i const columns_high = _mm_loadu_si128(
+			(__m128i const *)bitset->columns[1]
+			);
+		__m128i const bits = _mm_setr_epi8(
+			1, 2, 4, 8, 16, 32, 64, -128,
+			1, 2, 4, 8, 16, 32, 64, -128
+			);
+		__m128i const nibble_mask = _mm_set1_epi8(0xf);
+		__m128i const seven = _mm_set1_epi8(7);
+		for (; end - p >= 16; p += 16) {
+			__m128i const v = _mm_loadu_si128((__m128i const *)p);
+			__m128i const low = _mm_and_si128(v, nibble_mask);
+			__m128i const high = _mm_and_si128(
+				_mm_srli_epi16(v, 4),
+				nibble_mask
+				);
+			__m128i const is_high = _mm_cmpgt_epi8(high, seven);
+			__m128i const column = _mm_or_si128(
+				_mm_and_si128(
+					is_high,
+					_mm_shuffle_epi8(columns_high, low)
+					),
+				_mm_andnot_si128(
+					is_high,
+					_mm_shuffle_epi8(columns_low, low)
+					)
+				);
+			__m128i const bit = _mm_shuffle_epi8(bits, high);
+			unsigned mask = (unsigned)_mm_movemask_epi8(
+				_mm_cmpeq_epi8(_mm_and_si128(column, bit), bit)
+				);
+			if (mask) {
+				for (; !(mask & 1u); mask >>= 1)
+					++p;
+				return p;
+			}
+		}
+	}
+#endif
+	return find_character_byte_in_bitset_scalar(&bitset->set, p, end);
+}
+
+static bool
+is_plain_character_byte(
+	struct tokens_match_config const *const config,
+	char const ch
+	) {
+	switch (ch) {
+	case '*':
+	case '?':
+	case '@':
+	case '+':
+	case '!':
+	case '[':
+	case '\\':
+		return false;
+	default:
+		return
+			!in_character_byte_set(&config->separators.pattern, ch) &&
+			!in_character_byte_set(&config->separators.token, ch);
+	}
+}
+
+/* Measure the run of plain character bytes at the beginning of a pattern.
+ * A plain character byte is neither a special pattern character byte nor
+ * a separator character byte and therefore matches only itself.
+ * The non-plain character bytes are looked up from the analysis if any.
+ */
+static size_t
+measure_plain_character_bytes(
+	struct tokens_match_config const *const config,
+	char const *const pattern,
+	char const *const pattern_end
+	) {
+	char const *p = pattern;
+	if (!config->analysis) {
+		while (p < pattern_end && is_plain_character_byte(config, *p))
+			++p;
+		return (size_t)(p - pattern);
+	}
+	/* The patterns within extended patterns are matched without
+	 * separators.
+	 */
+	struct character_byte_bitset const *const non_plain =
+		config->separators.pattern.len || config->separators.token.len
+			? &config->analysis->non_plain
+			: &config->analysis->extended_non_plain;
+	while (p < pattern_end && !character_byte_bitset_contains(
+		non_plain,
+		*p
+		))
+		++p;
+	return (size_t)(p - pattern);
+}
+
 static char const *
 find_end_of_token(
 	struct tokens_match_config const *const config,
@@ -156,6 +415,14 @@ find_end_of_token(
 	assert(begin->tokens <= end->tokens_max);
 	assert(begin->pattern <= end->pattern);
 	assert(end->tokens_min <= end->tokens_max);
+	if (config->separators.token.len == 1u) {
+		char const *const tokens = memchr(
+			begin->tokens,
+			*config->separators.token.ptr,
+			(size_t)(end->tokens_max - begin->tokens)
+			);
+		return tokens ? tokens : end->tokens_max;
+	}
 	if (config->separators.token.len > 0u) {
 		char const *tokens = begin->tokens;
 		for (; tokens < end->tokens_max; ++tokens) {
@@ -265,6 +532,13 @@ find_tokens_pattern_tail(
 				current->pattern = tail->pattern;
 			break;
 		case CHARACTER_BYTE_CLASS_PATTERN:
+			if (wildcard_pattern && (
+				current->pattern == original_tail_pattern
+				))
+				/* Record the next character byte class.
+				 */
+				wildcard_pattern->next_character_byte_class =
+					original_tail_pattern;
 			break;
 		case CHARACTER_BYTE_PATTERN:
 			if (current->pattern == original_tail_pattern) {
@@ -313,6 +587,7 @@ find_tokens_pattern_tail(
 
 static char const *
 token_matches_pattern_list_partially(
+	struct tokens_match_config const *const config,
 	struct extended_pattern_info const *const info,
 	char const *const token,
 	char const *const token_end_min,
@@ -327,12 +602,26 @@ token_matches_pattern_list_partially(
 		return NULL;
 	if (token == token_end_min && info->match_len.min == 0u)
 		return token_end_min;
+	/* Plain character byte alternatives are matched in a single pass.
+	 */
+	struct pattern_trie const *const trie =
+		find_pattern_trie(config->tries, info->begin);
+	if (trie)
+		return pattern_trie_match(
+			trie,
+			token,
+			token_end_min,
+			token_end_max,
+			next_character_byte
+			);
 	/* The token does not contain separators.
 	 * Therefore, a zero config is enough.
 	 */
-	static struct tokens_match_config const config = {
+	struct tokens_match_config const zero_config = {
 		false,
-		{{0, ""}, {0, ""}}
+		{{0, ""}, {0, ""}},
+		config->tries,
+		config->analysis
 	};
 	for (struct tokens_pattern current = {token, info->begin};;) {
 		struct tokens_pattern_end const end = {
@@ -347,7 +636,7 @@ token_matches_pattern_list_partially(
 			next_character_byte
 		};
 		if (tokens_match_partially(
-			&config,
+			&zero_config,
 			&current,
 			&current,
 			&end,
@@ -392,14 +681,21 @@ tokens_match_extended_pattern_partially(
 		if (info->count.max > 0u && (
 			count >= info->count.min || info->match_len.min == 0u
 			)) {
-			if (tokens_match_partially(
+			bool const matches = tokens_match_partially(
 				config,
 				&tail,
 				current_out,
 				end,
 				token_end,
 				recursion_limit
-				))
+				);
+			TOKENS_MATCH_TRACE_ADD(
+				EXTENDED,
+				info->begin - 2,
+				tail.tokens,
+				matches
+				);
+			if (matches)
 				/* There are enough occurences (or there could
 				 * be enough empty occurences) and
 				 * the tokens match the rest of the pattern.
@@ -444,8 +740,9 @@ tokens_match_extended_pattern_partially(
 						return false;
 				}
 				assert(tail.tokens <= tail_tokens_max);
-				if (
+				bool const matches =
 					!token_matches_pattern_list_partially(
+						config,
 						info,
 						head_tokens,
 						tail.tokens,
@@ -460,8 +757,14 @@ tokens_match_extended_pattern_partially(
 						end,
 						token_end,
 						recursion_limit
-						)
-					)
+						);
+				TOKENS_MATCH_TRACE_ADD(
+					EXTENDED,
+					info->begin - 2,
+					tail.tokens,
+					matches
+					);
+				if (matches)
 					return true;
 				if (tail.tokens >= tail_tokens_max)
 					return false;
@@ -493,6 +796,7 @@ tokens_match_extended_pattern_partially(
 		char const *const tail_tokens_min = tail.tokens;
 		char const *const tail_tokens_initial =
 			token_matches_pattern_list_partially(
+				config,
 				info,
 				head_tokens,
 				tail_tokens_min,
@@ -541,6 +845,7 @@ tokens_match_extended_pattern_partially(
 			if (
 				tail.tokens == tail_tokens_initial ||
 				token_matches_pattern_list_partially(
+					config,
 					info,
 					head_tokens,
 					tail.tokens,
@@ -553,8 +858,23 @@ tokens_match_extended_pattern_partially(
 					/* Tail call optimization.
 					 */
 					break;
-				if (
-					recursion_limit &&
+				if (!recursion_limit) {
+					PROBE1(
+						tokens_match__recursion_limit,
+						info->begin
+						);
+					TOKENS_MATCH_STATS_ADD(
+						exhaustions,
+						1u
+						);
+					TOKENS_MATCH_TRACE_ADD(
+						LIMIT,
+						info->begin - 2,
+						tail.tokens,
+						false
+						);
+				}
+				bool const matches = recursion_limit &&
 					tokens_match_extended_pattern_partially(
 						config,
 						info,
@@ -564,8 +884,15 @@ tokens_match_extended_pattern_partially(
 						token_end,
 						recursion_limit - 1,
 						count + 1
-						)
-					)
+						);
+				if (recursion_limit)
+					TOKENS_MATCH_TRACE_ADD(
+						EXTENDED,
+						info->begin - 2,
+						tail.tokens,
+						matches
+						);
+				if (matches)
 					/* The tokens tail matches the extended
 					 * pattern with an increased occurence
 					 * count.
@@ -579,6 +906,47 @@ tokens_match_extended_pattern_partially(
 	}
 }
 
+/* Measure a pattern consisting of single character byte patterns only
+ * (character bytes, character byte classes and question marks).
+ * Returns false if the pattern contains other patterns.
+ */
+static bool
+measure_single_character_byte_patterns(
+	struct tokens_match_config const *const config,
+	char const *pattern,
+	char const *const pattern_end,
+	size_t *const len
+	) {
+	*len = 0u;
+	while (pattern < pattern_end) {
+		char character_byte;
+		struct character_byte_class_info character_byte_class;
+		struct extended_pattern_info extended_pattern;
+		struct wildcard_pattern_info wildcard_pattern;
+		bool const measure_extended_patterns_off = false;
+		switch (parse_next_pattern_entity(
+			&pattern,
+			pattern_end,
+			&config->separators.pattern,
+			&config->separators.token,
+			&character_byte,
+			&character_byte_class,
+			&extended_pattern,
+			&wildcard_pattern,
+			measure_extended_patterns_off
+			)) {
+		case WILDCARD_PATTERN_MATCH_ONE:
+		case CHARACTER_BYTE_CLASS_PATTERN:
+		case CHARACTER_BYTE_PATTERN:
+			++*len;
+			continue;
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
 static bool
 tokens_match_wildcard_pattern_partially(
 	struct tokens_match_config const *const config,
@@ -612,24 +980,114 @@ tokens_match_wildcard_pattern_partially(
 			*current_out = current;
 		return true;
 	}
-	if (!recursion_limit)
+	if (!recursion_limit) {
+		PROBE1(tokens_match__recursion_limit, current.pattern);
+		TOKENS_MATCH_STATS_ADD(exhaustions, 1u);
+		TOKENS_MATCH_TRACE_ADD(
+			LIMIT,
+			current.pattern,
+			current.tokens,
+			false
+			);
 		return false;
+	}
+	size_t tail_len;
+	if (
+		end->tokens_min == end->tokens_max &&
+		measure_single_character_byte_patterns(
+			config,
+			current.pattern,
+			end->pattern,
+			&tail_len
+			)
+		) {
+		/* The rest of the pattern has a fixed length and it cannot
+		 * match beyond the end of the token which must also be
+		 * the end of the match (such as in *@openssh.com).
+		 * Therefore, there is only one split point to try.
+		 */
+		if ((size_t)(token_end - current.tokens) < tail_len)
+			return false;
+		current.tokens = token_end - tail_len;
+		return tokens_match_partially(
+			config,
+			&current,
+			current_out,
+			end,
+			token_end,
+			recursion_limit - 1
+			);
+	}
+	/* Look up the next character byte class from the analysis or
+	 * prepare it once for all the split points.
+	 */
+	struct pattern_entity_bitset const *next_class = NULL;
+	struct pattern_entity_bitset next_class_data;
+	if (info->next_character_byte_class && config->analysis)
+		next_class = find_pattern_entity_bitset(
+			&config->analysis->classes,
+			info->next_character_byte_class
+			);
+	if (info->next_character_byte_class && !next_class) {
+		char const *pattern = info->next_character_byte_class;
+		struct character_byte_class_info character_byte_class;
+		bool const parsed = parse_character_byte_class_pattern(
+			&pattern,
+			end->pattern,
+			&character_byte_class
+			);
+		assert(parsed);
+		(void)parsed;
+		next_class_data.pattern = info->next_character_byte_class;
+		memset(&next_class_data.set, 0, sizeof next_class_data.set);
+		character_byte_bitset_add_class(
+			&next_class_data.set,
+			&character_byte_class
+			);
+		prepare_pattern_entity_bitset_columns(&next_class_data);
+		next_class = &next_class_data;
+	}
 	for (;; ++current.tokens) {
-		if (info->next_character_byte && !(current.tokens = memchr(
-			current.tokens,
-			*info->next_character_byte,
-			(size_t)(token_end - current.tokens)
-			)))
+		char const *next = current.tokens;
+		if (next_class)
+			next = find_character_byte_in_bitset(
+				next_class,
+				current.tokens,
+				token_end
+				);
+		else if (info->next_character_byte)
+			next = memchr(
+				current.tokens,
+				*info->next_character_byte,
+				(size_t)(token_end - current.tokens)
+				);
+		if (
+			info->next_character_byte_class ||
+			info->next_character_byte
+			)
+			TOKENS_MATCH_STATS_ADD(
+				compared,
+				(next ? next + 1 : token_end) - current.tokens
+				);
+		if (!next)
 			return false;
+		current.tokens = next;
 		assert(current.tokens <= token_end);
-		if (tokens_match_partially(
+		bool const matches = tokens_match_partially(
 			config,
 			&current,
 			current_out,
 			end,
 			token_end,
 			recursion_limit - 1
-			))
+			);
+		TOKENS_MATCH_TRACE_ADD(
+			WILDCARD,
+			current.pattern,
+			current.tokens,
+			matches
+			);
+		if (matches)
 			return true;
 		if (current.tokens >= token_end)
 			return false;
@@ -645,6 +1103,12 @@ tokens_match_partially(
 	char const *token_end,
 	unsigned const recursion_limit
 	) {
+	TOKENS_MATCH_STATS_ADD(calls, 1u);
+	PROBE1(tokens_match__call, recursion_limit);
+#ifdef TOKENS_MATCH_STATS
+	if (tokens_match_stats.recursion_limit_min > recursion_limit)
+		tokens_match_stats.recursion_limit_min = recursion_limit;
+#endif
 	if (token_end == NULL)
 		token_end = find_end_of_token(config, begin, end);
 	assert(begin->tokens <= token_end && token_end <= end->tokens_max);
@@ -652,12 +1116,14 @@ tokens_match_partially(
 	assert(end->tokens_min <= end->tokens_max);
 	struct tokens_pattern current = *begin;
 	while (current.pattern < end->pattern) {
+		TOKENS_MATCH_STATS_ADD(entities, 1u);
 		char character_byte;
 		struct character_byte_class_info character_byte_class;
 		struct extended_pattern_info extended_pattern;
 		struct wildcard_pattern_info wildcard_pattern;
 		bool const measure_extended_patterns_on = true;
 		struct tokens_pattern_end tail;
+		struct pattern_entity_bitset const *possessive;
 		if (token_end < current.tokens)
 			token_end = find_end_of_token(config, &current, end);
 		switch (parse_next_pattern_entity(
@@ -672,8 +1138,57 @@ tokens_match_partially(
 			measure_extended_patterns_on
 			)) {
 		case EXTENDED_PATTERN:
-			if (!recursion_limit)
+			if (!recursion_limit) {
+				PROBE1(
+					tokens_match__recursion_limit,
+					extended_pattern.begin
+					);
+				TOKENS_MATCH_STATS_ADD(exhaustions, 1u);
+				TOKENS_MATCH_TRACE_ADD(
+					LIMIT,
+					extended_pattern.begin - 2,
+					current.tokens,
+					false
+					);
 				return false;
+			}
+			possessive = config->analysis
+				? find_pattern_entity_bitset(
+					&config->analysis->possessive,
+					extended_pattern.begin
+					)
+				: NULL;
+			if (possessive) {
+				/* Match the longest run of the character bytes
+				 * in a single pass.
+				 */
+				char const *const head_tokens = current.tokens;
+				size_t const count_max =
+					extended_pattern.count.max;
+				char const *const run_end = (size_t)(
+					token_end - head_tokens
+					) > count_max
+					? head_tokens + count_max
+					: token_end;
+				while (
+					current.tokens < run_end &&
+					character_byte_bitset_contains(
+						&possessive->set,
+						*current.tokens
+						)
+					)
+					++current.tokens;
+				TOKENS_MATCH_STATS_ADD(
+					compared,
+					current.tokens - head_tokens +
+						(current.tokens < run_end)
+					);
+				if ((size_t)(
+					current.tokens - head_tokens
+					) < extended_pattern.count.min)
+					return false;
+				continue;
+			}
 			if (!find_tokens_pattern_tail(
 				config,
 				&current,
@@ -741,18 +1256,33 @@ tokens_match_partially(
 			 */
 			if (current.tokens >= token_end)
 				return false;
+			TOKENS_MATCH_STATS_ADD(compared, 1u);
 			if (!character_byte_matches_character_byte_class(
 				&character_byte_class,
 				*current.tokens
 				))
 				return false;
 			break;
-		case CHARACTER_BYTE_PATTERN:
-			if (current.tokens >= token_end)
+		case CHARACTER_BYTE_PATTERN: {
+			/* Compare the character byte and the following plain
+			 * character bytes (such as a key) at once.
+			 * The character byte itself is the last parsed one
+			 * (even if it was escaped).
+			 */
+			size_t const len = 1u + measure_plain_character_bytes(
+				config,
+				current.pattern,
+				end->pattern
+				);
+			if ((size_t)(token_end - current.tokens) < len)
 				return false;
-			if (*current.tokens != character_byte)
+			TOKENS_MATCH_STATS_ADD(compared, len);
+			if (memcmp(current.tokens, current.pattern - 1, len))
 				return false;
-			break;
+			current.tokens += len;
+			current.pattern += len - 1u;
+			continue;
+		}
 		case PATTERN_SEPARATOR_PATTERN:
 		case TOKEN_SEPARATOR_PATTERN:
 			/* A separator character byte matches itself or
@@ -760,6 +1290,7 @@ tokens_match_partially(
 			 */
 			if (current.tokens >= end->tokens_max)
 				return false;
+			TOKENS_MATCH_STATS_ADD(compared, 1u);
 			if (
 				*current.tokens != character_byte &&
 				current.tokens != token_end
@@ -775,6 +1306,7 @@ tokens_match_partially(
 	 */
 	assert(current.tokens <= end->tokens_max);
 	if (end->next_character_byte) {
+		TOKENS_MATCH_STATS_ADD(compared, 1u);
 		if (*current.tokens != *end->next_character_byte)
 			return false;
 	}
@@ -789,3 +1321,5 @@ tokens_match_partially(
 		*current_out = current;
 	return true;
 }
+
+#endif  /* TOKENS_MATCH_H */
@@ -0,0 +1,601 @@
+/*
+ * Copyright © 2025 Eero Häkkinen <Eero+pam-ssh-auth-info@Häkkinen.fi>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(_POSIX_C_SOURCE)
+#	define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#include "line_tokens_match.h"
+#include "pattern_analyze.h"
+#include "pattern_optimize.h"
+#include "pattern_trie_compile.h"
+
+/* The number of matches per timed sample.
+ */
+#define BATCH 8u
+
+struct bench_corpus {
+	char const *name;
+	/* The prefix and the length of a key (or NULL) and other lines.
+	 */
+	char const *key_prefix;
+	size_t key_len;
+	char const *lines;
+};
+
+struct bench_pattern {
+	char const *pattern_class;
+	char const *pattern;
+};
+
+/* SSH authentication information corpora.
+ * The keys are generated from the prefixes (the encoded key types) by
+ * appending pseudo-random base64 character bytes.
+ */
+static struct bench_corpus const corpora[] = {
+	{
+		"ed25519",
+		"publickey ssh-ed25519 AAAAC3NzaC1lZDI1NTE5AAAAI",
+		68u,
+		""
+	},
+	{
+		"rsa-4096",
+		"publickey ssh-rsa AAAAB3NzaC1yc2EAAAADAQABAAACAQ",
+		716u,
+		""
+	},
+	{
+		"sk",
+		"publickey sk-ssh-ed25519@openssh.com"
+		" AAAAGnNrLXNzaC1lZDI1NTE5QG9wZW5zc2guY29t",
+		124u,
+		""
+	},
+	{
+		"certificate",
+		"publickey ssh-ed25519-cert-v01@openssh.com"
+		" AAAAIHNzaC1lZDI1NTE5LWNlcnQtdjAxQG9wZW5zc2guY29t",
+		452u,
+		""
+	},
+	{
+		"multi-method",
+		"publickey ssh-rsa AAAAB3NzaC1yc2EAAAADAQABAAACAQ",
+		716u,
+		"keyboard-interactive/pam\n"
+		"password\n"
+	},
+	{
+		"adversarial",
+		NULL,
+		0u,
+		"publickey ssh-rsa AAAAAAAAAAAAAAAAX\n"
+	},
+	{NULL, NULL, 0u, NULL}
+};
+
+static struct bench_pattern const patterns[] = {
+	{"literal", "password"},
+	{"literal", "publickey=ssh-ed25519=*"},
+	{"list", "publickey=@(ssh-ed25519|ssh-rsa|ecdsa-sha2-nistp256"
+		"|sk-ssh-ed25519@openssh.com)=*"},
+	{"wildcard", "publickey=*-cert-v01@openssh.com=*"},
+	{"wildcard", "publickey=*=*AAAA*B"},
+	{"class", "publickey=ssh-ed25519=+([A-Za-z0-9+/])"},
+	{"nested", "publickey=*=*(*(A|AA)B)"},
+	{"nested", "publickey=*=+(+(A|AA))C"},
+	{NULL, NULL}
+};
+
+/* The samples of a pattern class or of a pattern and a corpus.
+ */
+struct bench_samples {
+	size_t len;
+	size_t size;
+	unsigned long *ns;
+	unsigned long matches;
+	unsigned long steps;
+	unsigned long steps_max;
+	unsigned depth_max;
+	unsigned long limited;
+};
+
+static void
+usage(FILE *const out, char const *const name) {
+	fprintf(
+		out,
+		"Usage: %s [-n <ITERATIONS>] [-r <RECURSION_LIMIT>]\n"
+		"\n"
+		"Benchmark the pattern matcher with realistic"
+		" SSH authentication information.\n"
+		"\n"
+		"Options:\n"
+		"  -h                  Show this help message and exit.\n"
+		"  -n ITERATIONS       The number of timed samples per"
+		" pattern and corpus\n"
+		"                      (default: 1000).\n"
+		"  -r RECURSION_LIMIT  The recursion limit (default: 100).\n",
+		name
+		);
+}
+
+static unsigned long
+now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long)ts.tv_sec * 1000000000ul +
+		(unsigned long)ts.tv_nsec;
+}
+
+/* Build the SSH authentication information of a corpus.
+ * Returns a string which must be freed with free or NULL if out of memory.
+ */
+static char *
+build_ssh_auth_info(struct bench_corpus const *const corpus) {
+	static char const base64[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+		"abcdefghijklmnopqrstuvwxyz"
+		"0123456789+/";
+	size_t const prefix_len =
+		corpus->key_prefix ? strlen(corpus->key_prefix) : 0u;
+	size_t const type_len = corpus->key_prefix
+		? (size_t)(strrchr(corpus->key_prefix, ' ') -
+			corpus->key_prefix) + 1u
+		: 0u;
+	size_t const key_line_len = prefix_len
+		? type_len + corpus->key_len + 1u
+		: 0u;
+	char *const s = malloc(key_line_len + strlen(corpus->lines) + 1u);
+	if (!s)
+		return NULL;
+	char *p = s;
+	if (prefix_len) {
+		unsigned long state = 1u;
+		memcpy(p, corpus->key_prefix, prefix_len);
+		p += prefix_len;
+		for (
+			size_t i = prefix_len - type_len;
+			i < corpus->key_len;
+			++i
+			) {
+			state = (state * 1103515245ul + 12345ul) &
+				0xFFFFFFFFul;
+			*p++ = base64[(state >> 16) % 64u];
+		}
+		*p++ = '\n';
+	}
+	strcpy(p, corpus->lines);
+	return s;
+}
+
+static bool
+add_sample(struct bench_samples *const samples, unsigned long const ns) {
+	if (samples->len == samples->size) {
+		size_t const size = samples->size ? 2u * samples->size : 1024u;
+		unsigned long *const p = realloc(
+			samples->ns,
+			size * sizeof *p
+			);
+		if (!p)
+			return false;
+		samples->size = size;
+		samples->ns = p;
+	}
+	samples->ns[samples->len++] = ns;
+	return true;
+}
+
+static int
+compare_ns(void const *const a, void const *const b) {
+	unsigned long const x = *(unsigned long const *)a;
+	unsigned long const y = *(unsigned long const *)b;
+	return x < y ? -1 : x > y;
+}
+
+static unsigned long
+percentile(struct bench_samples const *const samples, unsigned const p) {
+	return samples->ns[(samples->len - 1u) * p / 100u];
+}
+
+static void
+print_header(void) {
+	printf(
+		"%-8s %-36.36s %-12s %5s %8s %8s %8s %8s %10s %9s %9s %5s\n",
+		"class",
+		"pattern",
+		"corpus",
+		"match",
+		"p50 ns",
+		"p90 ns",
+		"p99 ns",
+		"max ns",
+		"matches/s",
+		"steps",
+		"max steps",
+		"depth"
+		);
+}
+
+static void
+print_samples(
+	char const *const pattern_class,
+	char const *const pattern,
+	char const *const corpus,
+	struct bench_samples *const samples,
+	unsigned long const evaluations
+	) {
+	qsort(samples->ns, samples->len, sizeof *samples->ns, compare_ns);
+	unsigned long total_ns = 0u;
+	for (size_t i = 0u; i < samples->len; ++i)
+		total_ns += samples->ns[i];
+	printf(
+		"%-8s %-36.36s %-12s %4lu%% %8lu %8lu %8lu %8lu %10.0f"
+		" %9lu %9lu %5u%s\n",
+		pattern_class,
+		pattern,
+		corpus,
+		samples->matches * 100u / evaluations,
+		percentile(samples, 50u),
+		percentile(samples, 90u),
+		percentile(samples, 99u),
+		samples->ns[samples->len - 1u],
+		total_ns ? (double)samples->len * 1e9 / (double)total_ns : 0.0,
+		samples->steps / evaluations,
+		samples->steps_max,
+		samples->depth_max,
+		samples->limited ? " (limited)" : ""
+		);
+}
+
+/* Match a pattern against the lines of SSH authentication information until
+ * the first matching line like pam_ssh_auth_info does.
+ */
+static bool
+ssh_auth_info_match(
+	char const *const ssh_auth_info,
+	char const *const pattern,
+	struct pattern_tries const *const tries,
+	struct pattern_analysis const *const analysis,
+	unsigned const recursion_limit
+	) {
+	for (char const *s = ssh_auth_info; *s;) {
+		if (first_line_tokens_match(
+			s,
+			pattern,
+			tries,
+			analysis,
+			true,
+			recursion_limit
+			))
+			return true;
+		s += strcspn(s, "\n");
+		if (*s == '\n')
+			++s;
+	}
+	return false;
+}
+
+/* Benchmark a pattern against a corpus.
+ * The samples are added to the class samples, too.
+ */
+static bool
+bench(
+	char const *const ssh_auth_info,
+	char const *const pattern,
+	struct pattern_tries const *const tries,
+	struct pattern_analysis const *const analysis,
+	unsigned const recursion_limit,
+	unsigned long const iterations,
+	struct bench_samples *const samples,
+	struct bench_samples *const class_samples
+	) {
+	for (unsigned long i = 0u; i < iterations; ++i) {
+		bool matches = false;
+		memset(&tokens_match_stats, 0, sizeof tokens_match_stats);
+		tokens_match_stats.recursion_limit_min = UINT_MAX;
+		unsigned long const start = now_ns();
+		for (unsigned j = 0u; j < BATCH; ++j) {
+			matches = ssh_auth_info_match(
+				ssh_auth_info,
+				pattern,
+				tries,
+				analysis,
+				recursion_limit
+				);
+		}
+		unsigned long const ns = (now_ns() - start) / BATCH;
+		/* A step is a partial match call or a parsed pattern entity.
+		 */
+		unsigned long const steps = (
+			tokens_match_stats.calls + tokens_match_stats.entities
+			) / BATCH;
+		unsigned const depth =
+			tokens_match_stats.recursion_limit_min < recursion_limit
+				? recursion_limit -
+					tokens_match_stats.recursion_limit_min
+				: 0u;
+		struct bench_samples *const all[] = {samples, class_samples};
+		for (size_t k = 0u; k < sizeof all / sizeof *all; ++k) {
+			if (!add_sample(all[k], ns))
+				return false;
+			all[k]->matches += matches;
+			all[k]->steps += steps;
+			if (all[k]->steps_max < steps)
+				all[k]->steps_max = steps;
+			if (all[k]->depth_max < depth)
+				all[k]->depth_max = depth;
+			if (tokens_match_stats.recursion_limit_min == 0u)
+				++all[k]->limited;
+		}
+	}
+	return true;
+}
+
+/* Time a batch of searches for the first character byte in a set.
+ * Returns the time per search.
+ */
+static unsigned long
+time_find_character_byte(
+	struct pattern_entity_bitset const *const bitset,
+	char const *const begin,
+	char const *const end,
+	bool const scalar,
+	bool *const found_all
+	) {
+	/* The beginning is read through a volatile pointer so that
+	 * the searches are not merged.
+	 */
+	char const *volatile const p = begin;
+	unsigned long const start = now_ns();
+	for (unsigned i = 0u; i < BATCH; ++i) {
+		char const *const found = scalar
+			? find_character_byte_in_bitset_scalar(
+				&bitset->set,
+				p,
+				end
+				)
+			: find_character_byte_in_bitset(bitset, p, end);
+		*found_all = *found_all && found;
+	}
+	return (now_ns() - start) / BATCH;
+}
+
+/* Benchmark finding the first character byte of a class in the keys of
+ * the corpora with the prepared nibble tables (with SSSE3) and one
+ * character byte at a time.
+ */
+static bool
+bench_find_character_byte(
+	char *const *const ssh_auth_infos,
+	unsigned long const iterations
+	) {
+	static struct character_byte_set const no_separators = {0, ""};
+	/* The end of a key (such as in *[!A-Za-z0-9+/]).
+	 */
+	char const *const pattern = "[!A-Za-z0-9+/]";
+	struct pattern_analysis *const analysis = analyze_patterns(
+		1,
+		&pattern,
+		&no_separators,
+		&no_separators
+		);
+	if (!analysis)
+		return false;
+	struct pattern_entity_bitset const *const bitset =
+		analysis->classes.ptr;
+	printf(
+		"%-12s %8s %10s %10s  (%s, SSSE3 %s)\n",
+		"corpus",
+		"bytes",
+		"p50 ns",
+		"scalar ns",
+		pattern,
+#ifdef __SSSE3__
+		"on"
+#else
+		"off"
+#endif
+		);
+	for (size_t i = 0u; corpora[i].name; ++i) {
+		if (!corpora[i].key_prefix)
+			continue;
+		char const *const begin =
+			strrchr(corpora[i].key_prefix, ' ') + 1 -
+				corpora[i].key_prefix +
+				ssh_auth_infos[i];
+		char const *const end = begin + strlen(begin);
+		struct bench_samples samples[2];
+		memset(samples, 0, sizeof samples);
+		bool found_all = true;
+		for (unsigned long j = 0u; j < iterations; ++j) {
+			for (int k = 0; k < 2; ++k) {
+				if (!add_sample(
+					&samples[k],
+					time_find_character_byte(
+						bitset,
+						begin,
+						end,
+						k,
+						&found_all
+						)
+					)) {
+					free(samples[0].ns);
+					free(samples[1].ns);
+					free(analysis);
+					return false;
+				}
+			}
+		}
+		for (int k = 0; k < 2; ++k)
+			qsort(
+				samples[k].ns,
+				samples[k].len,
+				sizeof *samples[k].ns,
+				compare_ns
+				);
+		printf(
+			"%-12s %8zu %10lu %10lu%s\n",
+			corpora[i].name,
+			(size_t)(end - begin),
+			percentile(&samples[0], 50u),
+			percentile(&samples[1], 50u),
+			found_all ? "" : " (not found)"
+			);
+		free(samples[0].ns);
+		free(samples[1].ns);
+	}
+	free(analysis);
+	return true;
+}
+
+int
+main(int argc, char **argv) {
+	static struct character_byte_set const
+		pattern_separators = {1, "="},
+		token_separators = {1, " "};
+	unsigned long iterations = 1000u;
+	unsigned recursion_limit = 100u;
+	int opt;
+	while ((opt = getopt(argc, argv, "hn:r:")) != -1) {
+		switch (opt) {
+		case 'h':
+			usage(stdout, argv[0]);
+			return 0;
+		case 'n':
+			iterations = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			recursion_limit = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(stderr, argv[0]);
+			return 2;
+		}
+	}
+	if (!iterations)
+		iterations = 1u;
+	char *ssh_auth_infos[sizeof corpora / sizeof *corpora];
+	for (size_t i = 0u; corpora[i].name; ++i) {
+		if (!(ssh_auth_infos[i] = build_ssh_auth_info(&corpora[i]))) {
+			fprintf(stderr, "out of memory\n");
+			return 2;
+		}
+	}
+	printf(
+		"recursion_limit = %u, %lu samples of %u matches"
+		" per pattern and corpus\n\n",
+		recursion_limit,
+		iterations,
+		BATCH
+		);
+	print_header();
+	struct bench_samples class_samples;
+	memset(&class_samples, 0, sizeof class_samples);
+	unsigned long class_evaluations = 0u;
+	for (size_t i = 0u; patterns[i].pattern; ++i) {
+		/* Match the optimized pattern with compiled tries and
+		 * an analysis like the module does.
+		 */
+		char optimized[256];
+		*optimize_pattern(
+			patterns[i].pattern,
+			patterns[i].pattern + strlen(patterns[i].pattern),
+			&pattern_separators,
+			&token_separators,
+			optimized
+			) = '\0';
+		char const *const optimized_pattern = optimized;
+		struct pattern_tries *const tries =
+			compile_pattern_tries(1, &optimized_pattern);
+		struct pattern_analysis *const analysis = analyze_patterns(
+			1,
+			&optimized_pattern,
+			&pattern_separators,
+			&token_separators
+			);
+		if (!tries || !analysis) {
+			fprintf(stderr, "out of memory\n");
+			return 2;
+		}
+		for (size_t j = 0u; corpora[j].name; ++j) {
+			struct bench_samples samples;
+			memset(&samples, 0, sizeof samples);
+			if (!bench(
+				ssh_auth_infos[j],
+				optimized_pattern,
+				tries,
+				analysis,
+				recursion_limit,
+				iterations,
+				&samples,
+				&class_samples
+				)) {
+				fprintf(stderr, "out of memory\n");
+				return 2;
+			}
+			class_evaluations += iterations;
+			print_samples(
+				patterns[i].pattern_class,
+				patterns[i].pattern,
+				corpora[j].name,
+				&samples,
+				iterations
+				);
+			free(samples.ns);
+		}
+		free(analysis);
+		free(tries);
+		/* Summarize the pattern class.
+		 */
+		if (
+			!patterns[i+1].pattern ||
+			strcmp(
+				patterns[i+1].pattern_class,
+				patterns[i].pattern_class
+				) != 0
+			) {
+			print_samples(
+				patterns[i].pattern_class,
+				"(all)",
+				"(all)",
+				&class_samples,
+				class_evaluations
+				);
+			printf("\n");
+			free(class_samples.ns);
+			memset(&class_samples, 0, sizeof class_samples);
+			class_evaluations = 0u;
+		}
+	}
+	if (!bench_find_character_byte(ssh_auth_infos, iterations)) {
+		fprintf(stderr, "out of memory\n");
+		return 2;
+	}
+	for (size_t i = 0u; corpora[i].name; ++i)
+		free(ssh_auth_infos[i]);
+	return 0;
+}
@@ -15,8 +15,10 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
 #include <string.h>
 
+#include "pattern_analyze.h"
 #include "tokens_match.h"
 
 static char const *
@@ -36,7 +38,7 @@ int LLVMFuzzerTestOneInput(uint8_t const* const data, size_t const size) {
 	 * The rest is ignored.
 	 * If pattern is missing, pattern = pattern_end = data_end.
 	 */
-	struct tokens_match_config const config = {
+	struct tokens_match_config config = {
 		.allow_prefix_match = !!(data[0] & 0x1u),
 		.separators = {
 			.pattern = {
@@ -59,13 +61,29 @@ int LLVMFuzzerTestOneInput(uint8_t const* const data, size_t const size) {
 	char const *const pattern_end = memchr_or_end(pattern, '\0', data_end);
 	if ((tokens_end - tokens) > 127 || (pattern_end - pattern) > 127)
 		return -1;  /* Reject. */
+	/* The pattern is analyzed as a null-terminated copy.
+	 */
+	char pattern_copy[128];
+	char const *const pattern_copy_ptr = pattern_copy;
+	memcpy(pattern_copy, pattern, (size_t)(pattern_end - pattern));
+	pattern_copy[pattern_end - pattern] = '\0';
+	struct pattern_analysis *const analysis = analyze_patterns(
+		1,
+		&pattern_copy_ptr,
+		&config.separators.pattern,
+		&config.separators.token
+		);
+	if (!analysis)
+		return -1;  /* Reject. */
+	config.analysis = analysis;
 	tokens_match(
 		&config,
 		first_line_tokens,
 		first_line_tokens_end,
-		pattern,
-		pattern_end,
+		pattern_copy,
+		pattern_copy + (pattern_end - pattern),
 		recursion_limit
 		);
+	free(analysis);
 	return 0;  /* Accept. The input may be added to the corpus. */
 }